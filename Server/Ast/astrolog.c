@@ -43,6 +43,7 @@ int naksatra = 0;
 int autodst = 0;
 int tithi = 0;
 int sunraise = 0;
+real rSunAlt = 0.0;
 int exportDesa = 0;
 int predasc = 0;
 float baseTT = 0;
@@ -55,6 +56,9 @@ int predictor = 0;
 int stockAspect = 0;
 int matchdata = 0;
 int yoga = 0;
+char *szPanchang = NULL;
+int nPanchangDay = 0;
+int fPanchangList = 0;
 
 extern int findDst(int, int, int, int);
 #endif
@@ -95,6 +99,9 @@ void Action()
 {
   char sz[cchSzDef];
   int i;
+#ifdef LOGAN
+  real rT;
+#endif
 
 #ifdef WIN
   is.fMult = fFalse;    /* Cleared here because no InitVariables routine. */
@@ -189,6 +196,25 @@ void Action()
   if (us.fWriteFile)        /* If -o switch in effect, then write */
     FOutputData();          /* the chart information to a file.   */
 
+#ifdef TIME
+  if (us.nBenchmark > 0)            /* If -Yb switch in effect, then time */
+    ChartBenchmark(us.nBenchmark);  /* casting that many charts.          */
+#endif
+
+#ifdef LOGAN
+  /* If -# switch in effect, then write a panchang event index file    */
+  /* covering the given number of days from the chart time onward, or  */
+  /* with -#l list the panchang over those days from an existing file. */
+
+  if (szPanchang != NULL) {
+    rT = MdytszToJulian(Mon, Day, Yea, Tim, Dst, Zon) - rRound;
+    if (fPanchangList)
+      ChartPanchang(szPanchang, rT, nPanchangDay);
+    else
+      FWritePanchang(szPanchang, rT, rT + (real)nPanchangDay);
+  }
+#endif
+
   if (S != stdout)    /* If we were internally directing chart display to a */
     fclose(S);        /* file as with the -os switch, close it here.        */
 
@@ -196,6 +222,11 @@ void Action()
     DeallocateFar(grid);
     grid = NULL;
   }
+  if (rgai) {
+    DeallocateFar(rgai);
+    rgai = NULL;
+    cai = caiMax = 0;
+  }
 }
 
 
@@ -337,6 +368,7 @@ char **argv;
   real r;
   char ch1, ch2;
   OE oe;
+  MS ms;
   lpbyte lpb;
   int FPTR *lpn;
   lpreal lpr;
@@ -397,6 +429,22 @@ char **argv;
     darg++;
     break;
 
+#ifdef TIME
+  case 'b':
+    if (argc <= 1) {
+      ErrorArgc("Yb");
+      return tcError;
+    }
+    i = atoi(argv[1]);
+    if (i < 0) {
+      ErrorValN("Yb", i);
+      return tcError;
+    }
+    us.nBenchmark = i;
+    darg++;
+    break;
+#endif
+
 #ifdef ARABIC
   case 'P':
     if (argc <= 1) {
@@ -433,6 +481,46 @@ char **argv;
     darg += 17;
     break;
 
+  case 'M':
+    if (ch1 == '0') {
+      cms = 0;
+      break;
+    }
+    if (argc <= 6) {
+      ErrorArgc("YM");
+      return tcError;
+    }
+    if (cms >= MAXSESSION) {
+      ErrorValN("YM", cms+1);
+      return tcError;
+    }
+    ms.lon = RParseSz(argv[2], pmLon);
+    ms.lat = RParseSz(argv[3], pmLat);
+    ms.zon = RParseSz(argv[4], pmZon);
+    ms.open = RParseSz(argv[5], pmTim);
+    ms.close = RParseSz(argv[6], pmTim);
+    if (!FValidLon(ms.lon)) {
+      ErrorValR("YM", ms.lon);
+      return tcError;
+    } else if (!FValidLat(ms.lat)) {
+      ErrorValR("YM", ms.lat);
+      return tcError;
+    } else if (!FValidZon(ms.zon)) {
+      ErrorValR("YM", ms.zon);
+      return tcError;
+    } else if (!FValidTim(ms.open)) {
+      ErrorValR("YM", ms.open);
+      return tcError;
+    } else if (!FValidTim(ms.close)) {
+      ErrorValR("YM", ms.close);
+      return tcError;
+    }
+    ms.nam = SzPersist(argv[1]);
+    ms.fLagna = ch1 == 'h';
+    rgms[cms++] = ms;
+    darg += 6;
+    break;
+
   case 'R':
     if (argc <= 2) {
       ErrorArgc("YR");
@@ -1414,6 +1502,24 @@ char **argv;
       break;
     case '=': /* Sun Raise */
       sunraise = 1;
+      if (ch1 == 'r')         /* Sun's centre, with refraction */
+        rSunAlt = -rSunRefract;
+      else if (ch1 == 'u')    /* Sun's upper limb, with refraction */
+        rSunAlt = -rSunRefract - rSunRadius;
+      else if (ch1 == 'a') {  /* Any altitude, e.g. -6 for civil twilight */
+        if (argc <= 1) {
+          ErrorArgc("=a");
+          return fFalse;
+        }
+        rT = atof(argv[1]);
+        if (rT < -rDegQuad || rT > rDegQuad) {
+          ErrorValR("=a", rT);
+          return fFalse;
+        }
+        rSunAlt = rT;
+        argc--; argv++;
+      } else
+        rSunAlt = 0.0;
       break;
     case 'O':
       regular = 0;
@@ -1427,6 +1533,20 @@ char **argv;
     case '!':
       matchdata = 1;
       break;
+    case '#': /* Panchang event index file */
+      if (argc <= 2) {
+        ErrorArgc("#");
+        return fFalse;
+      }
+      nPanchangDay = atoi(argv[2]);
+      if (nPanchangDay < 1) {
+        ErrorValN("#", nPanchangDay);
+        return fFalse;
+      }
+      szPanchang = SzPersist(argv[1]);
+      fPanchangList = ch1 == 'l';
+      argc -= 2; argv += 2;
+      break;
 #endif
 
     case 'b':
@@ -1713,6 +1833,17 @@ char **argv;
         SwitchF(us.fAnsi);
       break;
 
+    case '~':
+      if (ch1 == 'j')
+        us.nSink = skJson;
+      else if (ch1 == 'c')
+        us.nSink = skCsv;
+      else if (ch1 == 'b')
+        us.nSink = skBin;
+      else
+        us.nSink = skText;
+      break;
+
 #ifdef PCG
     case 'V':
       if (argc <= 1) {
@@ -1796,6 +1927,8 @@ main()
 #endif
   char szCommandLine[cchSzMax], *rgsz[MAXSWITCHES];
 
+  InitPrintBuffer();
+
   /* Read in info from the astrolog.dat file. */
   FProcessSwitchFile(DEFAULT_INFOFILE, NULL);
 
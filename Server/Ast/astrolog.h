@@ -78,6 +78,14 @@
 #define ENVIRON /* Comment out this #define if your system doesn't have  */
                 /* environment variables or can't compile calls to them. */
 
+#define MMAP /* Comment out this #define if your system can't map files into */
+             /* memory with the 'mmap' call as in sys/mman.h, such as most   */
+             /* PC's. Files are then read into allocated memory instead.     */
+
+#define THREADS /* Comment out this #define if your system doesn't have   */
+                /* POSIX threads as in pthread.h. Horoscope matching then */
+                /* scans all the candidates on the one thread instead.    */
+
 /*#define ATOF /* Comment out this #define if you have a system in which  */
              /* 'atof' and related functions aren't defined in stdio.h, */
              /* such as most PC's, Linux, VMS compilers, and NeXT's.    */
@@ -186,6 +194,8 @@
 #define MONTHSPACE 3   /* Number of spaces between each calendar column.   */
 #define MAXINDAY 250   /* Max number of aspects or transits displayable.   */
 #define MAXCROSS 750   /* Max number of latitude crossings displayable.    */
+#define MAXSESSION 16  /* Max number of market sessions definable by -YM.  */
+#define BATCHBLOCK 64  /* Charts cast before each transpose in a batch.     */
 #define CREDITWIDTH 74 /* Number of text columns in the -Hc credit screen. */
 #define MAXSWITCHES 32 /* Max number of switch parameters per input line.  */
 #define PSGUTTER 9     /* Points of white space on PostScript page edge.   */
@@ -444,6 +454,7 @@
 
 #define cchSzDef   80
 #define cchSzMax   255
+#define cchPrintBuf 65536
 #define nDegMax    360
 #define nDegHalf   180
 #define yeaJ2G     1582
@@ -463,6 +474,8 @@
 #define rSmall     (1.7453E-09)
 #define rLarge     10000.0
 #define rRound     0.5
+#define rSunRefract (34.0/60.0)
+#define rSunRadius  (16.0/60.0)
 
 #define chNull     '\0'
 #define chEscape   '\33'
@@ -582,6 +595,15 @@
 #define aQui 10
 #define aBQn 11
 
+/* Parts of a chart CastChartMask() can be asked to compute */
+
+#define cmObj   1   /* Bodies not restricted in ignore[].                  */
+#define cmHouse 2   /* House cusps, and which house each object is in.     */
+#define cmCusp  4   /* Angles, cusp objects, Vertex, and Part of Fortune.  */
+#define cmStar  8   /* Fixed stars, if -U is in effect.                    */
+#define cmLight 16  /* Sun and Moon, even if restricted in ignore[].       */
+#define cmAll   31
+
 #define brPhy 23.0
 #define brEmo 28.0
 #define brInt 33.0
@@ -778,6 +800,7 @@
 #define FAspect(asp)  FBetween(asp, 1, us.nAsp)
 #define ChDst(dst)    (dst == 0.0 ? 'S' : (dst == 1.0 ? 'D' : 'A'))
 #define DayInYearHi(yea) (365-28+DayInMonth(2, yea))
+#define NMinTim(tim)  ((int)RFloor(DecToDeg(tim)*60.0 + rRound))
 #define FChSwitch(ch) \
   ((ch) == '-' || (ch) == '/' || (ch) == '_' || (ch) == '=' || (ch) == ':')
 
@@ -976,6 +999,13 @@ typedef struct _GridInfo {
   short v[objMax][objMax];
 } GridInfo;
 
+typedef struct _AspectInfo {
+  int obj1, asp, obj2;  /* The aspect, with obj1 the lower object index. */
+  real rOrb;            /* Orb in degrees, signed as in the grid.        */
+  int nOrb;             /* The same orb in minutes of arc.               */
+  _bool fApp;           /* Whether the aspect is applying.               */
+} AspectInfo;
+
 typedef struct _CrossInfo {
   real lat[MAXCROSS];
   real lon[MAXCROSS];
@@ -983,6 +1013,288 @@ typedef struct _CrossInfo {
   int obj2[MAXCROSS];
 } CrossInfo;
 
+typedef struct _MarketSession {
+  char *nam;    /* Name of exchange.                              */
+  real lon;     /* Longitude of exchange.                         */
+  real lat;     /* Latitude of exchange.                          */
+  real zon;     /* Time zone exchange trades in.                  */
+  real open;    /* Time of day session opens.                     */
+  real close;   /* Time of day session closes.                    */
+  _bool fLagna; /* Only Lagna events limited to session hours.    */
+} MS;
+
+typedef struct _EventInfo {
+  real time;   /* Minutes into the period the event happens at.  */
+  real val;    /* Extra value, e.g. azimuth or altitude reached. */
+  int source;  /* Object making the event.                       */
+  int aspect;  /* Aspect made, or negative special event code.   */
+  int dest;    /* Object, sign, or state the event is made to.   */
+  int sign1;   /* Sign the source object is in at the time.      */
+  int sign2;   /* Sign the destination object is in at the time. */
+  int ret;     /* Retrograde state of the source object.         */
+} EI;
+
+typedef struct _EventList {
+  EI FPTR *rgei; /* The events found so far.              */
+  int cei;       /* Number of events currently in list.   */
+  int ceiMax;    /* Number of events there is room for.   */
+} EL;
+
+/* Panchang event index files, as written with -# and read back with */
+/* PnOpenPanchang(). Each record is the time a period starts and a   */
+/* code giving the kind of period and which one of that kind it is.  */
+
+#define PANCHANGVER 1
+#define pkNaksatra 0
+#define pkTithi    1
+#define pkYoga     2
+#define pkRasi     3
+#define cPanchang  4
+#define PanchangCode(pk, i) ((pk) << 8 | (i))
+#define PkFromCode(n) ((n) >> 8)
+#define IFromCode(n) ((n) & 255)
+
+/* Positions in whole arc seconds, as returned by LZodiacSec(), and the */
+/* Vedic divisions of the zodiac found directly from them.              */
+
+#define cSecCircle 1296000L  /* The whole zodiac.                   */
+#define cSecSign   108000L   /* 30 degrees, one rasi.               */
+#define cSecNak    48000L    /* 13:20, one nakshatra or yoga.       */
+#define cSecPada   12000L    /* 3:20, one pada or navamsa.          */
+#define cSecTithi  43200L    /* 12 degrees of Moon-Sun elongation.  */
+#define RasiFromSec(l)    ((int)((l)/cSecSign)+1)
+#define YogaFromSec(lSun, lMoon) ((int)(((lSun)+(lMoon))%cSecCircle/cSecNak))
+#define TithiFromSec(lSun, lMoon) \
+  ((int)(((lMoon)-(lSun)+cSecCircle)%cSecCircle/cSecTithi)+1)
+
+typedef struct _PanchangHeader {
+  char szMagic[4]; /* Always "PNCH", to identify the file.           */
+  int nVersion;    /* Format version, PANCHANGVER.                   */
+  int cpe;         /* Number of event records following the header.  */
+  int fSidereal;   /* Whether generated with -s sidereal zodiac.     */
+  real jdLo;       /* Julian day (UT) the events start at.           */
+  real jdHi;       /* Julian day (UT) the events end at.             */
+  real rOffset;    /* Sidereal zodiac offset in effect.              */
+} PH;
+
+typedef struct _PanchangEvent {
+  real jd;         /* Julian day (UT) the period starts at.          */
+  int code;        /* PanchangCode() of the kind and period started. */
+  int nReserved;   /* Unused, keeps records a fixed 16 bytes.        */
+} PE;
+
+typedef struct _PanchangIndex {
+  PH FPTR *pph;    /* Header at the start of the file in memory.     */
+  PE FPTR *rgpe;   /* Event records, sorted by time.                 */
+  int cpe;         /* Number of event records.                       */
+  long cb;         /* Size of the file in memory.                    */
+  _bool fMap;      /* Whether file was mapped rather than read in.   */
+} PN;
+
+/* Vimshottari dasa periods on Julian days. A period at any level divides */
+/* into 9 at the next, starting with its own lord and in proportion to    */
+/* each lord's years, so FDasaAt() can find the period in effect at any   */
+/* depth from just the 120 year cycle the birth falls in, working out     */
+/* only the periods along the way down.                                   */
+
+#define dlCycle      0
+#define dlDasa       1
+#define dlBhukti     2
+#define dlAntaram    3
+#define dlPratyantar 4
+#define dlSookshma   5
+#define rDasaYear 365.25  /* Days in each year of a dasa period. */
+
+typedef struct _DasaPeriod {
+  real jdStart;    /* Julian day the period starts at.                */
+  real jdEnd;      /* Julian day it ends, and the next one starts at. */
+  byte nLord;      /* Ruling graha, in desa.c's SUN to VENUS order.   */
+  byte nLevel;     /* dlCycle, dlDasa, dlBhukti, etc.                 */
+} DP;
+
+/* Nakshatra of a longitude and the dasa balance from it, as filled in */
+/* by NakshatraOf(), which is where they're always worked out.         */
+
+typedef struct _NakshatraInfo {
+  int rasi;        /* Sign, 0 to 11.                                 */
+  int nak;         /* Nakshatra, 0 to 26.                            */
+  int pada;        /* Pada within the nakshatra, 1 to 4.             */
+  int lord;        /* Dasa lord, in desa.c's SUN to VENUS order.     */
+  long secLeft;    /* Arc seconds left in the nakshatra.             */
+  real rBalance;   /* Years left of the lord's dasa.                 */
+  int years;       /* The same balance as whole years, twelfths of a */
+  int months;      /* year, and days, in years of rDasaYear days.    */
+  int days;
+} NK;
+
+/* Dasa timeline as built in memory by CreateDasaTimeline(). The periods  */
+/* down to antarams are stored a level at a time: the 9 dasas, then their */
+/* 81 bhuktis, then the 729 antarams. Each level covers the whole cycle   */
+/* in order with no gaps, so the period in effect at a time is found with */
+/* a binary search.                                                       */
+
+#define cDasaPeriod (9+81+729)
+#define IdpDasaLevel(dl) ((dl) == dlDasa ? 0 : ((dl) == dlBhukti ? 9 : 90))
+#define CdpDasaLevel(dl) ((dl) == dlDasa ? 9 : ((dl) == dlBhukti ? 81 : 729))
+
+typedef struct _DasaTimeline {
+  DP dpCycle;            /* The cycle the birth falls in.              */
+  DP rgdp[cDasaPeriod];  /* All periods, grouped and sorted by level.  */
+} DT;
+
+/* The nine grahas of Vedic charts, in the same order as the objects they */
+/* are, followed by the nodes, along with their natural dignities in the  */
+/* rasis and how each regards the others. Everything comes from the one   */
+/* GRAHADEF() list, which data.c expands into the lookup tables. Each row */
+/* gives the rasis the graha is exalted, debilitated, own (twice if just  */
+/* one), friendly, and enemy in, then bits for its friends and enemies.   */
+/* Any other rasi or graha is neutral, including the graha itself.        */
+
+#define cGraha 9
+#define grSun 0
+#define grMoo 1
+#define grMer 2
+#define grVen 3
+#define grMar 4
+#define grJup 5
+#define grSat 6
+#define grRah 7
+#define grKet 8
+#define GrBit(gr) (1 << (gr))
+
+#define dgNeutral     0
+#define dgExalted     1
+#define dgDebilitated 2
+#define dgOwn         3
+#define dgFriend      4
+#define dgEnemy       5
+
+#define reEnemy   0
+#define reNeutral 1
+#define reFriend  2
+
+#define GRAHADEF(G) \
+  G( 0,  6,  4,  4,  5,  7, GrBit(grMoo) | GrBit(grMar) | GrBit(grJup), \
+    GrBit(grVen) | GrBit(grSat))                   /* Sun     */ \
+  G( 1,  7,  3,  3,  5,  6, GrBit(grSun) | GrBit(grMer), \
+    0)                                             /* Moon    */ \
+  G( 5, 11,  2,  2,  3,  7, GrBit(grSun) | GrBit(grVen), \
+    GrBit(grMoo))                                  /* Mercury */ \
+  G(11,  5,  2,  6,  8,  7, GrBit(grMer) | GrBit(grSat), \
+    GrBit(grSun) | GrBit(grMoo))                   /* Venus   */ \
+  G( 9,  3,  0,  7,  2,  5, GrBit(grSun) | GrBit(grMoo) | GrBit(grJup), \
+    GrBit(grMer))                                  /* Mars    */ \
+  G( 3,  9,  8, 11,  5,  7, GrBit(grSun) | GrBit(grMoo) | GrBit(grMar), \
+    GrBit(grMer) | GrBit(grVen))                   /* Jupiter */ \
+  G( 6,  0,  9, 10,  1,  4, GrBit(grMer) | GrBit(grVen), \
+    GrBit(grSun) | GrBit(grMoo) | GrBit(grMar))    /* Saturn  */ \
+  G( 0,  6,  4,  4,  5,  7, 0, 0)                  /* Rahu    */ \
+  G( 0,  6,  4,  4,  5,  7, 0, 0)                  /* Ketu    */
+
+#define DgGraha(gr, rasi) (rgDignity[gr][rasi])
+#define ReGraha(gr1, gr2) (rgRelation[gr1][gr2])
+
+/* Horoscope matching. Each profile is reduced once to the Moon factors  */
+/* the kutas are scored from, stored a column per factor so a scan over  */
+/* many candidates only touches the few bytes it needs of each. Scores   */
+/* are kept in half points, so the 36 point Ashtakoota total is now 72.  */
+
+#define cNak 27
+#define cKuta 8
+#define nMatchMax 72
+#define kuVarna   0
+#define kuVashya  1
+#define kuTara    2
+#define kuYoni    3
+#define kuMaitri  4
+#define kuGana    5
+#define kuBhakoot 6
+#define kuNadi    7
+#define FKutaRasi(ku) ((ku) == kuVarna || (ku) == kuVashya || \
+  (ku) == kuMaitri || (ku) == kuBhakoot)
+
+typedef struct _MatchStore {
+  int cpr;             /* Number of profiles in the store.          */
+  int cprMax;          /* Number of profiles there is room for.     */
+  long FPTR *rgId;     /* Caller's id for each profile.             */
+  byte FPTR *rgNak;    /* Moon nakshatra, 0 for Aswini to 26.       */
+  byte FPTR *rgRasi;   /* Moon rasi, 0 for Mesha to 11.             */
+  byte FPTR *rgPada;   /* Moon pada, 1 to 4.                        */
+  byte FPTR *rgMale;   /* Whether a groom's, or a bride's.           */
+} MT;
+
+typedef struct _MatchResult {
+  int ipr;             /* Index of the candidate in the store.      */
+  int nScore;          /* Total of the kutas, in half points.       */
+} MR;
+
+/* State kept by CastChartStep() while a search casts chart after chart */
+/* for one location. The location is converted once when the search     */
+/* starts, and the Julian day of the date is kept for each step on it.  */
+
+typedef struct _ChartStep {
+  real lon;     /* Location as given in the chart info, which the */
+  real lat;     /* values below have been converted from.         */
+  real rLon;    /* Longitude in degrees, as ProcessInput() sets.  */
+  real rLat;    /* Latitude in radians, kept off the poles.       */
+  real rTanLat; /* Tangent of that latitude, for the angles.      */
+  int mon;      /* Date the Julian day below is for, or a month   */
+  int day;      /* of -1 if no chart has been cast yet.           */
+  int yea;
+  real jd;      /* Julian day of that date, from MdyToJulian().   */
+} CS;
+
+/* Output of FCastChartBatch(). Each array has one row per object or  */
+/* house cusp, holding that row's values for all charts in the batch  */
+/* next to each other. IBatch() gives the index of one chart's value. */
+
+typedef struct _ChartBatch {
+  int cci;              /* Number of charts in the batch.              */
+  lpreal rgObj;         /* Zodiac positions, objMax rows.              */
+  lpreal rgAlt;         /* Ecliptic latitudes, objMax rows.            */
+  lpreal rgDir;         /* Velocities in degrees per day, objMax rows. */
+  lpreal rgCusp;        /* House cusp positions, cSign+1 rows.         */
+} CB;
+
+#define IBatch(pcb, i, ici) ((long)(i)*(pcb)->cci + (ici))
+
+/* Output sinks, as chosen with -~, which the -v, -a, and -d charts give */
+/* their results to as typed records instead of text. Records are all a  */
+/* fixed 40 bytes, so the binary sink is just an SH header followed by   */
+/* the records exactly as they are in memory. Times are true Julian days */
+/* in UT, as JulianDayFromTime() gives, so 2000-01-01 12:00 UT is        */
+/* 2451545.0.                                                            */
+
+#define skText 0
+#define skJson 1
+#define skCsv  2
+#define skBin  3
+#define FSink() (us.nSink != skText)
+
+#define SINKVER 1
+#define rkPosition 0
+#define rkAspect   1
+#define rkEvent    2
+#define rkDasa     3
+
+typedef struct _SinkHeader {
+  char szMagic[4]; /* Always "SINK", to identify the stream.          */
+  int nVersion;    /* Format version, SINKVER.                        */
+  int cbRecord;    /* Size of each record that follows, sizeof(SR).   */
+  int fSidereal;   /* Whether positions are in the sidereal zodiac.   */
+} SH;
+
+typedef struct _SinkRecord {
+  real jd;         /* Julian day (UT) of the chart, event, or period. */
+  real r1;         /* Longitude, orb, sign of event source, or end.   */
+  real r2;         /* Latitude, power, or sign of event destination.  */
+  real r3;         /* Velocity in degrees per day.                    */
+  short rk;        /* rkPosition, rkAspect, rkEvent, or rkDasa.       */
+  short obj1;      /* Object, event source, or dasa lord's graha.     */
+  short asp;       /* Aspect, negative event code, or dasa level.     */
+  short obj2;      /* Other object, sign, or state, or house.         */
+} SR;
+
 #ifdef GRAPH
 #define KV unsigned long
 #define KI int
@@ -1097,6 +1409,8 @@ typedef struct _UserSettings {
   int   nScrollRow;      /* -YQ */
   long  lTimeAddition;   /* -Yz */
   int   nArabicNight;    /* -YP */
+  int   nSink;           /* -~  */
+  int   nBenchmark;      /* -Yb */
 } US;
 
 typedef struct _InternalSettings {
@@ -1118,6 +1432,7 @@ typedef struct _InternalSettings {
   real rSid;          /* Sidereal offset degrees to be added to locations. */
   real JD;            /* Fractional Julian day for current chart.          */
   real JDp;           /* Julian day that a progressed chart indicates.     */
+  CS *pcs;            /* Search stepping state while in CastChartStep().   */
 } IS;
 
 typedef struct _ChartInfo {
@@ -203,24 +203,44 @@ int housesystem;
 void ComputeStars(SD)
 real SD;
 {
+  static real rgStarLon[cStar+1], rgStarLat[cStar+1];
+  static int nStarPrev = -1;
   int i, j;
   real x, y, z;
 
-  /* Read in star positions. */
-
+  /* Star positions are fixed for epoch 2000 and are converted with the  */
+  /* constant J2000 obliquity, so convert them only the first time. Each */
+  /* chart just adds its own precession or ayanamsa offset afterward.    */
+
+  if (nStarPrev < 0) {
+    for (i = 1; i <= cStar; i++) {
+      x = rStarData[i*6-6]; y = rStarData[i*6-5]; z = rStarData[i*6-4];
+      rgStarLon[i] = RFromD(x*rDegMax/24.0+y*15.0/60.0+z*0.25/60.0);
+      x = rStarData[i*6-3]; y = rStarData[i*6-2]; z = rStarData[i*6-1];
+      rgStarLat[i] = RFromD(x+y/60.0+z/60.0/60.0);
+      /* Convert to ecliptic zodiac coordinates. */
+      EquToEcl(&rgStarLon[i], &rgStarLat[i]);
+      rgStarLon[i] = DFromR(rgStarLon[i]);
+      rgStarLat[i] = DFromR(rgStarLat[i]);
+    }
+  }
   for (i = 1; i <= cStar; i++) {
-    x = rStarData[i*6-6]; y = rStarData[i*6-5]; z = rStarData[i*6-4];
-    planet[oNorm+i] = RFromD(x*rDegMax/24.0+y*15.0/60.0+z*0.25/60.0);
-    x = rStarData[i*6-3]; y = rStarData[i*6-2]; z = rStarData[i*6-1];
-    planetalt[oNorm+i] = RFromD(x+y/60.0+z/60.0/60.0);
-    /* Convert to ecliptic zodiac coordinates. */
-    EquToEcl(&planet[oNorm+i], &planetalt[oNorm+i]);
-    planet[oNorm+i] = Mod(DFromR(planet[oNorm+i])+rEpoch2000+SD);
-    planetalt[oNorm+i] = DFromR(planetalt[oNorm+i]);
+    planet[oNorm+i] = Mod(rgStarLon[i]+rEpoch2000+SD);
+    planetalt[oNorm+i] = rgStarLat[i];
     ret[oNorm+i] = RFromD(rDegMax/26000.0/365.25);
-    starname[i] = i;
   }
 
+  /* Sorting by name, brightness, or latitude gives the same order every */
+  /* time, so only sort again when the switch changes. Sorting by zodiac */
+  /* position starts from the last order, which is then nearly sorted.   */
+
+  if (us.nStar == nStarPrev && us.nStar != 'z')
+    return;
+  if (us.nStar != nStarPrev)
+    for (i = 1; i <= cStar; i++)
+      starname[i] = i;
+  nStarPrev = us.nStar;
+
   /* Sort the index list if -Uz, -Ul, -Un, or -Ub switch in effect. */
 
   if (us.nStar > 1) for (i = 2; i <= cStar; i++) {
@@ -304,8 +324,9 @@ real r, azi, alt, *rx, *ry, *rz;
 /* such as Moon and Node velocities not available without -b are. (This is  */
 /* the one place in Astrolog which calls the Placalc package functions.)    */
 
-void ComputePlacalc(t)
+void ComputePlacalc(t, fLight)
 real t;
+bool fLight;
 {
   int i;
   real r1, r2, r3, r4;
@@ -315,7 +336,7 @@ real t;
   /* The other objects must be done elsewhere.                           */
 
   for (i = oSun; i <= oLil; i++) {
-    if ((ignore[i] && i > oMoo) ||
+    if ((ignore[i] && (i > oMoo || !fLight)) ||
       (us.fPlacalcAst && FBetween(i, oCer, oVes)))
       continue;
     if (FPlacalcPlanet(i, t*36525.0+2415020.0, us.objCenter != oSun,
@@ -345,10 +366,25 @@ real t;
 
 real CastChart(fDate)
 bool fDate;
+{
+  return CastChartMask(fDate, cmAll);
+}
+
+
+/* Like CastChart() but only compute the parts of the chart the caller is */
+/* going to look at, as given by the cm* flags in the mask parameter. The */
+/* bodies computed are those not restricted in ignore[], which unlike in  */
+/* full charts includes the Sun and Moon unless cmLight is set, so that a */
+/* search needing e.g. just the Moon or Ascendant can skip all the rest.  */
+
+real CastChartMask(fDate, cm)
+bool fDate;
+int cm;
 {
   CI ci;
   real housetemp[cSign+1], Off = 0.0, vtx, j;
   int i, k;
+  bool fLight = (cm & cmLight) > 0, fPlanet = fLight || !ignore[oSun];
 
   /* Hack: Time zone +/-24 means to have the time of day be in Local Mean */
   /* Time (LMT). This is done by making the time zone value reflect the   */
@@ -373,53 +409,66 @@ bool fDate;
     ComputeVariables(&vtx);
     if (us.fGeodetic)               /* Check for -G geodetic chart. */
       RA = RFromD(Mod(-OO));
-    MC  = CuspMidheaven();          /* Calculate our Ascendant & Midheaven. */
-    Asc = CuspAscendant();
-    ComputeHouses(us.nHouseSystem); /* Go calculate house cusps. */
-
-    /* Go calculate planet, Moon, and North Node positions. */
-
-    ComputePlanets();
-    if (!ignore[oMoo] || !ignore[oNod] || !ignore[oSou] || !ignore[oFor]) {
-      ComputeLunar(&planet[oMoo], &planetalt[oMoo],
-        &planet[oNod], &planetalt[oNod]);
-      ret[oNod] = -1.0;
+    if (cm & (cmHouse | cmCusp)) {
+      MC  = CuspMidheaven();        /* Calculate our Ascendant & Midheaven. */
+      Asc = CuspAscendant();
+      ComputeHouses(us.nHouseSystem); /* Go calculate house cusps. */
     }
 
-    /* Compute more accurate ephemeris positions for certain objects. */
+    /* Go calculate planet, Moon, and North Node positions. The Sun is    */
+    /* done whenever any planet is, as the Earth's orbit comes from it.   */
+
+    if (cm & cmObj) {
+      for (i = oMer; !fPlanet && i <= (us.fUranian ? oNorm : cPlanet);
+        i += (i != cPlanet ? 1 : uranLo-cPlanet))
+        fPlanet = !ignore[i];
+      if (fPlanet)
+        ComputePlanets();
+      if (!ignore[oMoo] || !ignore[oNod] || !ignore[oSou] ||
+        (!ignore[oFor] && (cm & cmCusp))) {
+        ComputeLunar(&planet[oMoo], &planetalt[oMoo],
+          &planet[oNod], &planetalt[oNod]);
+        ret[oNod] = -1.0;
+      }
+
+      /* Compute more accurate ephemeris positions for certain objects. */
 
 #ifdef PLACALC
-    if (us.fPlacalc)
-      ComputePlacalc(T);
+      if (us.fPlacalc)
+        ComputePlacalc(T, fLight);
 #endif
-    if (!us.fPlacalc) {
-      planet[oSou] = Mod(planet[oNod]+rDegHalf);
-      ret[oSou] = ret[oNod] = RFromD(-0.053);
-      ret[oMoo] = RFromD(12.5);
+      if (!us.fPlacalc) {
+        planet[oSou] = Mod(planet[oNod]+rDegHalf);
+        ret[oSou] = ret[oNod] = RFromD(-0.053);
+        ret[oMoo] = RFromD(12.5);
+      }
     }
 
-    /* Calculate position of Part of Fortune. */
+    if (cm & cmCusp) {
+
+      /* Calculate position of Part of Fortune. */
 
-    j = planet[oMoo]-planet[oSun];
-    if (us.nArabicNight < 0)
-      neg(j);
-    j = RAbs(j) < rDegQuad ? j : j - RSgn(j)*rDegMax;
-    planet[oFor] = Mod(j+Asc);
+      j = planet[oMoo]-planet[oSun];
+      if (us.nArabicNight < 0)
+        neg(j);
+      j = RAbs(j) < rDegQuad ? j : j - RSgn(j)*rDegMax;
+      planet[oFor] = Mod(j+Asc);
 
-    /* Fill in "planet" positions corresponding to house cusps. */
+      /* Fill in "planet" positions corresponding to house cusps. */
 
-    planet[oVtx] = vtx; planet[oEP] = CuspEastPoint();
-    for (i = 2; i <= cSign; i++)
-      planet[cuspLo + i - 1] = house[i];
-    planet[oAsc] = Asc; planet[oMC] = MC;
-    planet[oDes] = Mod(Asc + rDegHalf); planet[oNad] = Mod(MC + rDegHalf);
-    for (i = oFor; i <= cuspHi; i++)
-      ret[i] = RFromD(rDegMax);
+      planet[oVtx] = vtx; planet[oEP] = CuspEastPoint();
+      for (i = 2; i <= cSign; i++)
+        planet[cuspLo + i - 1] = house[i];
+      planet[oAsc] = Asc; planet[oMC] = MC;
+      planet[oDes] = Mod(Asc + rDegHalf); planet[oNad] = Mod(MC + rDegHalf);
+      for (i = oFor; i <= cuspHi; i++)
+        ret[i] = RFromD(rDegMax);
+    }
   }
 
   /* Go calculate star positions if -U switch in effect. */
 
-  if (us.nStar)
+  if (us.nStar && (cm & cmStar))
     ComputeStars(us.fSidereal ? 0.0 : -Off);
 
   /* Transform ecliptic to equatorial coordinates if -sr in effect. */
@@ -462,11 +511,12 @@ bool fDate;
       planetalt[i] = ret[i] = 0.0;
     }
 
-  ComputeInHouses();        /* Figure out what house everything falls in. */
+  if (cm & cmHouse)
+    ComputeInHouses();      /* Figure out what house everything falls in. */
 
   /* If -f domal chart switch in effect, switch planet and house positions. */
 
-  if (us.fFlip) {
+  if (us.fFlip && (cm & cmHouse)) {
     for (i = 1; i <= cObj; i++) {
       k = inhouse[i];
       inhouse[i] = SFromZ(planet[i]);
@@ -487,7 +537,8 @@ bool fDate;
   if (us.fDecan) {
     for (i = 1; i <= cObj; i++)
       planet[i] = Decan(planet[i]);
-    ComputeInHouses();
+    if (cm & cmHouse)
+      ComputeInHouses();
   }
 
   ciCore = ci;
@@ -495,6 +546,329 @@ bool fDate;
 }
 
 
+/* Set up to cast a series of charts at the given location with           */
+/* CastChartStep(), as the -d, -t, -E, and -Zd searches do. The location  */
+/* is converted here once, rather than on every step as CastChart() does. */
+
+void BeginChartStep(pcs, lon, lat)
+CS *pcs;
+real lon, lat;
+{
+  pcs->lon = lon; pcs->lat = lat;
+  pcs->rLon = DecToDeg(lon);
+  lat = Min(lat, 89.9999);
+  lat = Max(lat, -89.9999);
+  pcs->rLat = RFromD(DecToDeg(lat));
+  pcs->rTanLat = RTan(pcs->rLat);
+  pcs->mon = -1;
+}
+
+
+/* Cast the chart in ciCore as CastChartMask() does, for a time during a   */
+/* search set up with BeginChartStep(). Only what changes with the time is */
+/* worked out afresh: the location was converted when the search began,    */
+/* and the Julian day is only recomputed when the date changes. A chart    */
+/* for anywhere else is just cast in full.                                 */
+
+real CastChartStep(pcs, cm)
+CS *pcs;
+int cm;
+{
+  real t;
+
+  is.pcs = OO == pcs->lon && AA == pcs->lat ? pcs : NULL;
+  t = CastChartMask(fTrue, cm);
+  is.pcs = NULL;
+  return t;
+}
+
+
+/* Cast a whole batch of unrelated charts, e.g. when precomputing a list */
+/* of subscribers or running a backtest, and store the results in the    */
+/* given batch structure. Each object's positions for all the charts are */
+/* kept together, so callers can run down one object across the batch.   */
+/* The rgfIgnore array is like ignore[] and says which objects to skip,  */
+/* or is NULL to use ignore[] itself.                                    */
+/*                                                                       */
+/* This only changes how the results are laid out. Each chart is still   */
+/* one full CastChartMask() call, as the planet routines work on global  */
+/* state one chart at a time, so a batch is cast no faster than the same */
+/* charts one by one apart from the objects it skips. Charts are cast a  */
+/* block at a time into a scratch buffer, which is then transposed into  */
+/* the output rows so the copying never writes with a big stride.        */
+
+bool FCastChartBatch(rgci, cci, rgfIgnore, pcb)
+CI *rgci;
+int cci;
+byte *rgfIgnore;
+CB *pcb;
+{
+  byte rgfIgnoreSav[objMax];
+  lpreal rgrStage;
+  lpreal pr;
+  lpreal prSrc;
+  CI ciSav;
+  long lcb;
+  int cStage = 3*objMax + cSign+1, cm, ici, ici0, cBlock, i, k;
+
+  pcb->cci = cci;
+  lcb = sizeof(real)*(long)cci;
+  pcb->rgObj = (lpreal)PAllocate(lcb*objMax, fTrue, "chart batch");
+  pcb->rgAlt = (lpreal)PAllocate(lcb*objMax, fTrue, "chart batch");
+  pcb->rgDir = (lpreal)PAllocate(lcb*objMax, fTrue, "chart batch");
+  pcb->rgCusp = (lpreal)PAllocate(lcb*(cSign+1), fTrue, "chart batch");
+  rgrStage = (lpreal)PAllocate(sizeof(real)*(long)BATCHBLOCK*cStage, fFalse,
+    "chart batch");
+  if (pcb->rgObj == NULL || pcb->rgAlt == NULL || pcb->rgDir == NULL ||
+    pcb->rgCusp == NULL || rgrStage == NULL) {
+    FreeChartBatch(pcb);
+    if (rgrStage != NULL)
+      DeallocateFar(rgrStage);
+    return fFalse;
+  }
+
+  ciSav = ciCore;
+  for (i = 0; i < objMax; i++) {
+    rgfIgnoreSav[i] = ignore[i];
+    if (rgfIgnore != NULL)
+      ignore[i] = rgfIgnore[i];
+  }
+  cm = cmObj | cmCusp | cmStar | (!ignore[oFor] ? cmLight : 0);
+
+  for (ici0 = 0; ici0 < cci; ici0 += BATCHBLOCK) {
+    cBlock = Min(cci - ici0, BATCHBLOCK);
+
+    /* Cast each chart in the block, saving its values to the scratch area. */
+
+    for (k = 0; k < cBlock; k++) {
+      ciCore = rgci[ici0 + k];
+      CastChartMask(fTrue, cm);
+      pr = &rgrStage[(long)k*cStage];
+      for (i = 0; i < objMax; i++) {
+        pr[i] = ignore[i] ? 0.0 : planet[i];
+        pr[objMax + i] = ignore[i] ? 0.0 : planetalt[i];
+        pr[2*objMax + i] = ignore[i] ? 0.0 : DFromR(ret[i]);
+      }
+      for (i = 0; i <= cSign; i++)
+        pr[3*objMax + i] = i > 0 ? house[i] : 0.0;
+    }
+
+    /* Transpose the block into the output rows, one row at a time. */
+
+    for (i = 0; i < cStage; i++) {
+      if (i < objMax)
+        pr = &pcb->rgObj[IBatch(pcb, i, ici0)];
+      else if (i < 2*objMax)
+        pr = &pcb->rgAlt[IBatch(pcb, i - objMax, ici0)];
+      else if (i < 3*objMax)
+        pr = &pcb->rgDir[IBatch(pcb, i - 2*objMax, ici0)];
+      else
+        pr = &pcb->rgCusp[IBatch(pcb, i - 3*objMax, ici0)];
+      prSrc = &rgrStage[i];
+      for (k = 0; k < cBlock; k++)
+        pr[k] = prSrc[(long)k*cStage];
+    }
+  }
+
+  for (i = 0; i < objMax; i++)
+    ignore[i] = rgfIgnoreSav[i];
+  DeallocateFar(rgrStage);
+  ciCore = ciSav;
+  return fTrue;
+}
+
+
+/* Free the arrays allocated for a batch of charts by FCastChartBatch(). */
+
+void FreeChartBatch(pcb)
+CB *pcb;
+{
+  if (pcb->rgObj != NULL)
+    DeallocateHuge(pcb->rgObj);
+  if (pcb->rgAlt != NULL)
+    DeallocateHuge(pcb->rgAlt);
+  if (pcb->rgDir != NULL)
+    DeallocateHuge(pcb->rgDir);
+  if (pcb->rgCusp != NULL)
+    DeallocateHuge(pcb->rgCusp);
+  pcb->rgObj = pcb->rgAlt = pcb->rgDir = pcb->rgCusp = NULL;
+  pcb->cci = 0;
+}
+
+
+#ifdef TIME
+/* Time casting the given number of charts, each a day after the one      */
+/* before starting from the current chart, first one at a time with       */
+/* CastChart() and then as one batch with FCastChartBatch(), as done with */
+/* the -Yb switch. This gives repeatable figures for how fast charts are  */
+/* cast by this build on this machine, and checks that both ways agree on */
+/* the positions of every unrestricted object.                            */
+
+void ChartBenchmark(cci)
+int cci;
+{
+  char sz[cchSzDef];
+  CI *rgci;
+  CB cb;
+  clock_t clk;
+  real rSingle, rBatch, rDiff = 0.0, r;
+  int ici, i;
+
+  rgci = (CI *)PAllocate(sizeof(CI)*(long)cci, fFalse, "benchmark");
+  if (rgci == NULL)
+    return;
+  for (ici = 0; ici < cci; ici++) {
+    rgci[ici] = ciMain;
+    rgci[ici].day += ici;
+  }
+
+  clk = clock();
+  if (!FCastChartBatch(rgci, cci, NULL, &cb)) {
+    DeallocateFar(rgci);
+    return;
+  }
+  rBatch = (real)(clock() - clk) / (real)CLOCKS_PER_SEC;
+
+  clk = clock();
+  for (ici = 0; ici < cci; ici++) {
+    ciCore = rgci[ici];
+    CastChart(fTrue);
+    for (i = 1; i <= cObj; i++) if (!ignore[i]) {
+      r = MinDistance(planet[i], cb.rgObj[IBatch(&cb, i, ici)]);
+      if (r > rDiff)
+        rDiff = r;
+    }
+  }
+  rSingle = (real)(clock() - clk) / (real)CLOCKS_PER_SEC;
+
+  rSingle = Max(rSingle, 1.0 / (real)CLOCKS_PER_SEC);
+  rBatch = Max(rBatch, 1.0 / (real)CLOCKS_PER_SEC);
+  sprintf(sz, "Cast %d charts one at a time in %.3f seconds (%.0f/s).\n",
+    cci, rSingle, (real)cci / rSingle); PrintSz(sz);
+  sprintf(sz, "Cast %d charts as one batch in %.3f seconds (%.0f/s).\n",
+    cci, rBatch, (real)cci / rBatch); PrintSz(sz);
+  sprintf(sz, "Largest difference between them: %.9f degrees.\n", rDiff);
+  PrintSz(sz);
+
+  FreeChartBatch(&cb);
+  DeallocateFar(rgci);
+  ciCore = ciMain;
+  CastChart(fTrue);
+}
+#endif
+
+
+/* Compute the Ascendant, Midheaven, and house cusps for many locations */
+/* at one moment, e.g. for a map of rising signs across a list of       */
+/* cities. The moment is a Julian day in UT, in the JulianDayFromTime() */
+/* sense, while longitudes (west positive, as in Astrolog) and          */
+/* latitudes are given in decimal degrees. Sidereal time, obliquity,    */
+/* and the zodiac offset are found once from the moment alone; each     */
+/* block of locations then has its angles and default Placidus cusps    */
+/* worked out together. Cusps go in rgCusp as cSign+1 rows of cpt       */
+/* values, like the rows in a CB, or aren't computed if rgCusp is NULL. */
+/* A location too far north or south for Placidus or Koch houses uses   */
+/* Porphyry instead of stopping the whole batch. The chart's own angles */
+/* and cusps are left as they were, so this is safe mid listing.        */
+
+void CastHouseBatch(jd, rgLon, rgLat, cpt, rgAsc, rgMC, rgCusp)
+real jd;
+CONST real *rgLon, *rgLat;
+int cpt;
+real *rgAsc, *rgMC, *rgCusp;
+{
+  static real rgPlacDeg[7] = {0.0, 0.0, 120.0, 150.0, 0.0, 30.0, 60.0},
+    rgPlacFF[7] = {0.0, 0.0, 1.5, 3.0, 0.0, 3.0, 1.5};
+  real rgRA[BATCHBLOCK], rgAA[BATCHBLOCK], rgr[BATCHBLOCK],
+    housetemp[cSign+1];
+  real t, RA0, rSid, RASav, AASav, MCSav, AscSav, OBSav, rSidSav,
+    rSinOB, rCosOB, X;
+  int ipt0, cBlock, i, j;
+  bool fPlacidus;
+
+  RASav = RA; AASav = AA; MCSav = MC; AscSav = Asc;
+  OBSav = OB; rSidSav = is.rSid;
+  for (i = 1; i <= cSign; i++)
+    housetemp[i] = house[i];
+
+  /* The same sidereal time, obliquity, and offset ProcessInput() finds. */
+
+  t = (jd - 2415020.0) / 36525.0;
+  RA0 = (6.6460656+2400.0513*t+2.58E-5*t*t+RFract(jd+rRound)*24.0)*15.0;
+  OB = RFromD(23.452294-0.0130125*t);
+  rSid = (us.fSidereal ? RSiderealOffset(t) : 0.0) + us.rZodiacOffset;
+  is.rSid = rSid;
+  rSinOB = RSin(OB); rCosOB = RCos(OB);
+
+  for (ipt0 = 0; ipt0 < cpt; ipt0 += BATCHBLOCK) {
+    cBlock = Min(cpt - ipt0, BATCHBLOCK);
+    fPlacidus = us.nHouseSystem == 0;
+
+    /* Sidereal time and the angles for each location in the block. */
+
+    for (j = 0; j < cBlock; j++) {
+      X = Max(Min(rgLat[ipt0 + j], 89.9999), -89.9999);
+      rgAA[j] = RFromD(X);
+      if (RAbs(X) > rDegQuad-rAxis)
+        fPlacidus = fFalse;
+      rgRA[j] = RFromD(Mod(us.fGeodetic ? -rgLon[ipt0 + j] :
+        RA0-rgLon[ipt0 + j]));
+      X = RAtn(RTan(rgRA[j])/rCosOB);
+      if (X < 0.0)
+        X += rPi;
+      if (rgRA[j] > rPi)
+        X += rPi;
+      rgMC[ipt0 + j] = Mod(DFromR(X)+rSid);
+      X = Angle(-RSin(rgRA[j])*rCosOB-RTan(rgAA[j])*rSinOB, RCos(rgRA[j]));
+      rgAsc[ipt0 + j] = Mod(DFromR(X)+rSid);
+    }
+    if (rgCusp == NULL)
+      continue;
+
+    /* Placidus houses, the default, are done for the block together. */
+
+    if (fPlacidus) {
+      for (j = 0; j < cBlock; j++) {
+        rgCusp[(long)cpt + ipt0 + j] = rgAsc[ipt0 + j];
+        rgCusp[4L*cpt + ipt0 + j] = Mod(rgMC[ipt0 + j]+rDegHalf);
+      }
+      for (i = 2; i <= 6; i++) {
+        if (i == 4)
+          continue;
+        CuspPlacidusBatch(rgPlacDeg[i], rgPlacFF[i], i < 4,
+          rgRA, rgAA, rgr, cBlock);
+        for (j = 0; j < cBlock; j++)
+          rgCusp[(long)i*cpt + ipt0 + j] =
+            Mod(rgr[j]+(i > 4 ? rDegHalf : 0.0)+rSid);
+      }
+      for (i = 7; i <= cSign; i++)
+        for (j = 0; j < cBlock; j++)
+          rgCusp[(long)i*cpt + ipt0 + j] =
+            Mod(rgCusp[(long)(i-6)*cpt + ipt0 + j]+rDegHalf);
+      continue;
+    }
+
+    /* Any other system is done one location at a time. */
+
+    for (j = 0; j < cBlock; j++) {
+      RA = rgRA[j]; AA = rgAA[j];
+      MC = rgMC[ipt0 + j]; Asc = rgAsc[ipt0 + j];
+      if (us.nHouseSystem < 2 && RAbs(AA) > RFromD(rDegQuad-rAxis))
+        HousePorphyry();
+      else
+        ComputeHouses(us.nHouseSystem);
+      for (i = 1; i <= cSign; i++)
+        rgCusp[(long)i*cpt + ipt0 + j] = house[i];
+    }
+  }
+
+  RA = RASav; AA = AASav; MC = MCSav; Asc = AscSav;
+  OB = OBSav; is.rSid = rSidSav;
+  for (i = 1; i <= cSign; i++)
+    house[i] = housetemp[i];
+}
+
+
 /*
 ******************************************************************************
 ** Aspect Calculations.
@@ -513,6 +887,19 @@ bool FEnsureGrid()
 }
 
 
+/* Likewise set up the table MarkAspectPairs() fills in, which at objMax */
+/* squared longs is too big to put on the stack in each caller.          */
+
+bool FEnsureAspectPairs()
+{
+  if (rglAsp != NULL)
+    return fTrue;
+  rglAsp = (long (FPTR *)[objMax])PAllocate(sizeof(long)*objMax*objMax,
+    fFalse, "aspect pairs");
+  return rglAsp != NULL;
+}
+
+
 /* Indicate whether some aspect between two objects should be shown. */
 
 bool FAcceptAspect(obj1, asp, obj2)
@@ -551,64 +938,194 @@ int obj1, asp, obj2;
 }
 
 
-/* This is a subprocedure of FCreateGrid() and FCreateGridRelation().   */
-/* Given two planets, determine what aspect, if any, is present between */
-/* them, and save the aspect name and orb in the specified grid cell.   */
+/* This is a subprocedure of FCreateGrid(), FCreateGridRelation(), and    */
+/* FCreateAspectList(). Given two planets, determine what aspect, if any, */
+/* is present between them, and return the aspect along with its orb and  */
+/* whether it is applying. Only the aspects whose bits are set in lAsp,   */
+/* as found by MarkAspectPairs(), are checked.                            */
 
-void GetAspect(planet1, planet2, ret1, ret2, i, j)
+int NGetAspect(planet1, planet2, ret1, ret2, i, j, lAsp, prOrb, pfApp)
 real *planet1, *planet2, *ret1, *ret2;
 int i, j;
+long lAsp;
+real *prOrb;
+bool *pfApp;
 {
-  int k;
-  real l, m;
+  int k, asp = 0;
+  real l, m, s;
 
-  grid->v[i][j] = grid->n[i][j] = 0;
   l = MinDistance(planet2[i], planet1[j]);
   for (k = us.nAsp; k >= 1; k--) {
-    if (!FAcceptAspect(i, k, j))
+    if (!(lAsp & (1L << k)) || !FAcceptAspect(i, k, j))
       continue;
     m = l-rAspAngle[k];
     if (RAbs(m) < GetOrb(i, j, k)) {
-      grid->n[i][j] = k;
+      asp = k;
 
-      /* If -ga switch in effect, then change the sign of the orb to    */
-      /* correspond to whether the aspect is applying or separating.    */
-      /* To do this, we check the velocity vectors to see if the        */
-      /* planets are moving toward, away, or are overtaking each other. */
+      /* Check the velocity vectors to see if the planets are moving       */
+      /* toward, away, or are overtaking each other. If -ga switch in      */
+      /* effect, then change the sign of the orb to correspond to whether  */
+      /* the aspect is applying or separating.                             */
 
+      s = RSgn2(ret1[j]-ret2[i])*
+        RSgn2(MinDifference(planet2[i], planet1[j]))*RSgn2(m);
+      *pfApp = s < 0.0;
       if (us.fAppSep)
-        m = RSgn2(ret1[j]-ret2[i])*
-          RSgn2(MinDifference(planet2[i], planet1[j]))*RSgn2(m)*RAbs(m);
-      grid->v[i][j] = (int)(m*60.0);
+        m = s*RAbs(m);
+      *prOrb = m;
     }
   }
+  return asp;
 }
 
 
-/* Very similar to GetAspect(), this determines if there is a parallel or */
-/* contraparallel aspect between the given two planets, and stores the    */
-/* result as above. The settings and orbs for conjunction are used for    */
-/* parallel and those for opposition are used for contraparallel.         */
+/* Determine the aspect between two planets as above, and save the aspect */
+/* name and orb in the specified grid cell.                               */
 
-void GetParallel(planet1, planet2, planetalt1, planetalt2, i, j)
+void GetAspect(planet1, planet2, ret1, ret2, i, j, lAsp)
+real *planet1, *planet2, *ret1, *ret2;
+int i, j;
+long lAsp;
+{
+  real m;
+  bool fApp;
+
+  grid->n[i][j] =
+    NGetAspect(planet1, planet2, ret1, ret2, i, j, lAsp, &m, &fApp);
+  grid->v[i][j] = grid->n[i][j] ? (int)(m*60.0) : 0;
+}
+
+
+/* Very similar to NGetAspect(), this determines if there is a parallel   */
+/* or contraparallel aspect between the given two planets, and returns it */
+/* and its orb as above. The settings and orbs for conjunction are used   */
+/* for parallel and those for opposition are used for contraparallel.     */
+
+int NGetParallel(planet1, planet2, planetalt1, planetalt2, i, j, prOrb)
 real *planet1, *planet2, *planetalt1, *planetalt2;
 int i, j;
+real *prOrb;
 {
-  int k;
+  int k, asp = 0;
   real l, alt1, alt2;
 
   l = RFromD(planet1[j]); alt1 = RFromD(planetalt1[j]);
   EclToEqu(&l, &alt1); alt1 = DFromR(alt1);
   l = RFromD(planet2[i]); alt2 = RFromD(planetalt2[i]);
   EclToEqu(&l, &alt2); alt2 = DFromR(alt2);
-  grid->v[i][j] = grid->n[i][j] = 0;
   for (k = Min(us.nAsp, aOpp); k >= 1; k--) {
     if (!FAcceptAspect(i, k, j))
       continue;
     l = RAbs(k == aCon ? alt1 - alt2 : RAbs(alt1) - RAbs(alt2));
     if (l < GetOrb(i, j, k)) {
-      grid->n[i][j] = k;
-      grid->v[i][j] = (int)(l*60.0);
+      asp = k;
+      *prOrb = l;
+    }
+  }
+  return asp;
+}
+
+
+/* Determine the parallel aspect between two planets as above, and store */
+/* the result in the specified grid cell.                                */
+
+void GetParallel(planet1, planet2, planetalt1, planetalt2, i, j)
+real *planet1, *planet2, *planetalt1, *planetalt2;
+int i, j;
+{
+  real l;
+
+  grid->n[i][j] =
+    NGetParallel(planet1, planet2, planetalt1, planetalt2, i, j, &l);
+  grid->v[i][j] = grid->n[i][j] ? (int)(l*60.0) : 0;
+}
+
+
+/* Rather than test every pair of objects against every aspect, find      */
+/* which aspects each pair could possibly be within orb of. The objects   */
+/* are sorted by longitude in each of planet1 and planet2 once. Then for  */
+/* each aspect, the sorted planet1 objects are swept around the circle,   */
+/* with a window on either side of each covering the widest orb the       */
+/* aspect can have with that object. Since the windows move forward in    */
+/* step, the planet2 objects inside them are found without any searching. */
+/* Bit k of rgl[i][j] is set for object i in planet2 and object j in      */
+/* planet1, matching how GetAspect() is called. Aspects not marked can't  */
+/* be present, while those marked still need GetAspect() to apply the     */
+/* exact orb rules.                                                       */
+
+void MarkAspectPairs(planet1, planet2, rgl)
+real *planet1, *planet2;
+long rgl[objMax][objMax];
+{
+  real rgr[objMax*3], rgr1[objMax], rgrOrb[objMax], rAdd = -rDegMax,
+    rOrbMax, rAng, r;
+  int rgobj[objMax*3], rgobj1[objMax], cobj = 0, i, j, k, n, lo;
+
+  /* Sort the unrestricted objects by longitude in both lists, and find  */
+  /* the largest orb addition among them. The planet2 list is repeated   */
+  /* three times a circle apart, so that windows that have wrapped       */
+  /* around 0 Aries in either direction can be scanned straight through. */
+
+  for (i = 1; i <= cObj; i++) if (!ignore[i]) {
+    r = i <= oNorm ? rObjAdd[i] : 0.0; rAdd = Max(rAdd, r);
+    for (j = cobj; j > 0 && rgr[j-1] > planet2[i]; j--) {
+      rgr[j] = rgr[j-1]; rgobj[j] = rgobj[j-1];
+    }
+    rgr[j] = planet2[i]; rgobj[j] = i;
+    for (j = cobj; j > 0 && rgr1[j-1] > planet1[i]; j--) {
+      rgr1[j] = rgr1[j-1]; rgobj1[j] = rgobj1[j-1];
+    }
+    rgr1[j] = planet1[i]; rgobj1[j] = i;
+    cobj++;
+  }
+  for (i = 0; i < cobj; i++) {
+    rgr[cobj+i] = rgr[i]+rDegMax; rgobj[cobj+i] = rgobj[i];
+    rgr[cobj*2+i] = rgr[i]+rDegMax*2.0; rgobj[cobj*2+i] = rgobj[i];
+    for (j = 0; j < cobj; j++)
+      rgl[rgobj[i]][rgobj[j]] = 0L;
+  }
+
+  for (k = 1; k <= us.nAsp; k++) {
+    if (ignorea(k))
+      continue;
+
+    /* The widest orb this aspect can have with each object, as GetOrb() */
+    /* would compute it against the most generous other object.          */
+
+    rOrbMax = 0.0;
+    for (j = 0; j < cobj; j++) {
+      i = rgobj1[j];
+      r = i > oNorm ? 2.0 : rObjOrb[i];
+      rgrOrb[j] = Min(rAspOrb[k], r) + (i <= oNorm ? rObjAdd[i] : 0.0) +
+        rAdd + rSmall;
+      rOrbMax = Max(rOrbMax, rgrOrb[j]);
+    }
+    if (rOrbMax <= 0.0 || rAspAngle[k] - rOrbMax >= rDegHalf)
+      continue;
+
+    /* Orbs of a quarter circle or more are too wide to sweep, so just */
+    /* mark every pair of objects for them.                            */
+
+    if (rOrbMax >= rDegQuad) {
+      for (j = 0; j < cobj; j++)
+        for (i = 0; i < cobj; i++)
+          rgl[rgobj[i]][rgobj1[j]] |= 1L << k;
+      continue;
+    }
+    for (n = 0; n < 2; n++) {
+      r = rAspAngle[k] <= rDegHalf ? rAspAngle[k] : rDegMax-rAspAngle[k];
+      if (n && (r == 0.0 || r == rDegHalf))
+        break;
+      rAng = (n ? -r : r) + rDegMax;
+      lo = 0;
+      for (j = 0; j < cobj; j++) {
+        r = rgr1[j] + rAng;
+        while (lo < cobj*3 && rgr[lo] < r - rOrbMax)
+          lo++;
+        for (i = lo; i < cobj*3 && rgr[i] <= r + rgrOrb[j]; i++)
+          if (rgr[i] >= r - rgrOrb[j])
+            rgl[rgobj[i]][rgobj1[j]] |= 1L << k;
+      }
     }
   }
 }
@@ -625,6 +1142,11 @@ bool fFlip;
 
   if (!FEnsureGrid())
     return fFalse;
+  if (!us.fParallel) {
+    if (!FEnsureAspectPairs())
+      return fFalse;
+    MarkAspectPairs(planet, planet, rglAsp);
+  }
   for (j = 1; j <= cObj; j++) if (!ignore[j])
     for (i = 1; i <= cObj; i++) if (!ignore[i])
 
@@ -634,8 +1156,10 @@ bool fFlip;
       if (fFlip ? i > j : i < j) {
         if (us.fParallel)
           GetParallel(planet, planet, planetalt, planetalt, i, j);
+        else if (rglAsp[i][j])
+          GetAspect(planet, planet, ret, ret, i, j, rglAsp[i][j]);
         else
-          GetAspect(planet, planet, ret, ret, i, j);
+          grid->v[i][j] = grid->n[i][j] = 0;
       } else if (fFlip ? i < j : i > j) {
         l = Mod(Midpoint(planet[i], planet[j])); k = (int)l;  /* Calculate */
         grid->n[i][j] = k/30+1;                               /* midpoint. */
@@ -660,13 +1184,20 @@ bool fMidpoint;
 
   if (!FEnsureGrid())
     return fFalse;
+  if (!fMidpoint && !us.fParallel) {
+    if (!FEnsureAspectPairs())
+      return fFalse;
+    MarkAspectPairs(cp1.obj, cp2.obj, rglAsp);
+  }
   for (j = 1; j <= cObj; j++) if (!ignore[j])
     for (i = 1; i <= cObj; i++) if (!ignore[i])
       if (!fMidpoint) {
         if (us.fParallel)
           GetParallel(cp1.obj, cp2.obj, cp1.alt, cp2.alt, i, j);
+        else if (rglAsp[i][j])
+          GetAspect(cp1.obj, cp2.obj, cp1.dir, cp2.dir, i, j, rglAsp[i][j]);
         else
-          GetAspect(cp1.obj, cp2.obj, cp1.dir, cp2.dir, i, j);
+          grid->v[i][j] = grid->n[i][j] = 0;
       } else {
         l = Mod(Midpoint(cp2.obj[i], cp1.obj[j])); k = (int)l; /* Calculate */
         grid->n[i][j] = k/30+1;                                /* midpoint. */
@@ -676,6 +1207,59 @@ bool fMidpoint;
 }
 
 
+/* Make a list of just the aspects taking place among the unrestricted    */
+/* planets in the present chart, in the same order they'd appear going    */
+/* down the columns of the aspect grid, but without filling in the whole  */
+/* grid. Reports that only walk the aspects present can use this instead. */
+
+bool FCreateAspectList()
+{
+  int rgobj[objMax], cobj = 0, n, i, j;
+  bool fApp;
+  AspectInfo FPTR *pai;
+
+  for (i = 1; i <= cObj; i++) if (!ignore[i])
+    rgobj[cobj++] = i;
+  n = cobj*(cobj-1)/2;
+  if (n > caiMax) {
+    if (rgai != NULL)
+      DeallocateFar(rgai);
+    cai = caiMax = 0;
+    rgai = (AspectInfo FPTR *)PAllocate(sizeof(AspectInfo)*(long)n, fFalse,
+      "aspect list");
+    if (rgai == NULL)
+      return fFalse;
+    caiMax = n;
+  }
+  cai = 0;
+  if (!us.fParallel) {
+    if (!FEnsureAspectPairs())
+      return fFalse;
+    MarkAspectPairs(planet, planet, rglAsp);
+  }
+  for (j = 1; j < cobj; j++)
+    for (i = 0; i < j; i++) {
+      if (!us.fParallel && !rglAsp[rgobj[i]][rgobj[j]])
+        continue;
+      pai = &rgai[cai];
+      pai->obj1 = rgobj[i]; pai->obj2 = rgobj[j]; pai->fApp = fFalse;
+      if (us.fParallel)
+        pai->asp = NGetParallel(planet, planet, planetalt, planetalt,
+          pai->obj1, pai->obj2, &pai->rOrb);
+      else {
+        pai->asp = NGetAspect(planet, planet, ret, ret, pai->obj1,
+          pai->obj2, rglAsp[pai->obj1][pai->obj2], &pai->rOrb, &fApp);
+        pai->fApp = fApp;
+      }
+      if (pai->asp) {
+        pai->nOrb = (int)(pai->rOrb*60.0);
+        cai++;
+      }
+    }
+  return fTrue;
+}
+
+
 /* Fill out tables based on the number of unrestricted planets in signs by  */
 /* element, signs by mode, as well as other values such as the number of    */
 /* objects in yang vs. yin signs, in various house hemispheres (north/south */
@@ -311,6 +311,8 @@ void DisplaySwitches()
   PrintS(" _o <file> [..]: Write parameters of current chart to file.");
   PrintS(" _o0 <file> [..]: Like _o but output planet/house positions.");
   PrintS(" _os <file>, > <file>: Redirect output of text charts to file.");
+  PrintS(" _# <file> <days>: Write panchang event index file for days.");
+  PrintS(" _#l <file> <days>: List panchang for days from index file.");
   PrintS("\nSwitches which affect what information is used in a chart:");
   PrintS(" _R [<obj1> [<obj2> ..]]: Restrict specific bodies from displays.");
   PrintS(" _R0 [<obj1> ..]: Like _R but restrict everything first.");
@@ -378,6 +380,7 @@ void DisplaySwitches()
 #endif /* TIME */
   PrintS("\nSwitches to access graphics options:");
   PrintS(" _k: Display text charts using Ansi characters and color.");
+  PrintS(" _~[j,c,b]: Give _v, _a, _d results as JSON, CSV, or binary.");
 #ifdef MSG
   PrintS(" _V: <25,43,50>: Start up with text mode set to number of rows.");
 #endif
@@ -413,12 +416,19 @@ void DisplaySwitchesRare()
   PrintS(" _YQ <rows>: Pause text scrolling after a page full has printed.");
   PrintS(" _Yo: Output chart info and position files in old style format.");
   PrintS(" _Yz <min>: Forward clock by amount for current moment charts.");
+#ifdef TIME
+  PrintS(" _Yb <charts>: Time casting charts singly and as a batch.");
+#endif
 #ifdef ARABIC
   PrintS(" _YP <-1,0,1>: Set how Arabic parts are computed for night charts.");
 #endif
   PrintS(" _YE <obj> <semi-major axis> <eccentricity (3)> <inclination (3)>");
   PrintS("     <perihelion (3)> <ascending node (3)> <time offset (3)>");
   PrintS("     Change orbit of object to be the given elements.");
+  PrintS(" _YM[h] <name> <lon> <lat> <zone> <open> <close>");
+  PrintS("     Add market session that -d -Yt limits events at location to.");
+  PrintS("     A home session limits only Lagna events to its hours.");
+  PrintS(" _YM0: Clear the list of market sessions.");
   PrintS(
     " _YR <obj1> <obj2> <flag1>..<flag2>: Set restrictions for object range.");
   PrintS(
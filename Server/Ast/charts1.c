@@ -71,15 +71,15 @@ real lret[objMax];
                         "Tiruvonam", "Avitam", "Sathayam",
                         "Puratathi", "Utartathi", "Revati" }; 
 
-  int nakdeg[]      = {  0,  800,  1600,  2400,
-                         3200,  4000,  4800,
-                         5600,  6400,  7200,
-                         8000,  8800,  9600,
-                        10400, 11200, 12000,
-                        12800, 13600, 14400,
-                        15200, 16000, 16800,
-                        17600, 18400, 19200,
-                        20000, 20800, 21600 };
+  char *rasis[] = { "Mesham", "Vrishabham", "Mithunam",
+                    "Katakam", "Simham", "Kanya",
+                    "Tulam", "Vrishchikam", "Dhanus",
+                    "Makaram", "Kumbham", "Minam" };
+
+  /* Dasa lords, in the SUN to VENUS order desa.c and NakshatraOf() use. */
+
+  char *szDasaLord[] = { "Sun", "Moon", "Mars", "Rahu", "Jupiter",
+                         "Saturn", "Mercury", "Ketu", "Venus" };
 
   char *yogas[] = { "Vishkamba", "Preeti", "Aayushmaan",
                     "Saubhaagys", "Sobhana", "Atiganda",
@@ -122,26 +122,45 @@ real lret[objMax];
       Smax
   };
 
-  int pindex[] = { 5, 4, 3,
-                   2, 1, 3,
-                   4, 5, 6,
-                   7, 7, 6 };
-
-  struct {
-    char name[4];
-    int count;
-    int index[8];
-    char planet[8][12];
-    char mdeg[8][12];
-    char deg[8][12];
-    int navacount;
-    int navaindex[8];
-    char navamsam[8][12];
-  } chr[12];
-
-  struct {
-      int index;
-  } ind[Smax][Pmax];
+  int pindex[] = { Mars, Venus, Mercury,
+                   Moon, Sun, Mercury,
+                   Venus, Mars, Jupiter,
+                   Saturn, Saturn, Jupiter };
+
+  /* Names of the grahas in the Rasi and Amsam charts, and the order they */
+  /* are listed in the Amsam chart and printed in with getRuler().        */
+
+  char *szGraha[] = { "Sun", "Moon", "Merc", "Venu", "Mars", "Jupi",
+                      "Satu", "Rahu", "Ketu" };
+  int rgAmsaOrder[Pmax] = { Moon, Sun, Mercury, Venus, Mars, Jupiter,
+                            Saturn, Rahu, Ketu, Lag1, Lag2, Lag3 };
+
+/* The Vedic chart being listed. ChartListing() clears this and places    */
+/* each body in it once per chart, and all the Vedic text output is then  */
+/* formatted from it. Bodies are kept in the order the Rasi chart lists   */
+/* them, and the grahas and Lagnas can also be found directly by index    */
+/* through ivb[], which is -1 for any not placed.                         */
+
+typedef struct _VedicBody {
+  int graha;      /* Sun to Lag3, or -1 for any other object.    */
+  char sz[6];     /* Name shown for the body in the charts.      */
+  char chMark;    /* 'R' or 'F' if retrograde or fast, ' ' if    */
+                  /* neither, or chNull to show no flag at all.  */
+  long l;         /* Position in arc seconds, from LZodiacSec(). */
+  int rasi;       /* Sign, 0 to 11.                              */
+  int deg;        /* Degree and minute within the sign, rounded  */
+  int min;        /* as they're displayed.                       */
+  int nak;        /* Nakshatra, 0 to 26.                         */
+  int pada;       /* Pada within the nakshatra, 1 to 4.          */
+  int navamsa;    /* Sign of the navamsa, 0 to 11.               */
+  int house;      /* House counted from the Lagna, or 0 if none. */
+  int dignity;    /* Dignity of a graha in its rasi.             */
+  int dignityNav; /* Dignity of a graha in its navamsa.          */
+} VedicBody;
+
+  VedicBody rgvb[objMax+Pmax];
+  int cvb;
+  int ivb[Pmax];
 
   extern int csv;
   extern int autodst;
@@ -150,14 +169,11 @@ real lret[objMax];
   extern int navamsam;
   extern int predictor;
 
-  enum {
-      NEUTRAL,
-      EXALTED,
-      DEBILITATED,
-      OWN,
-      FRIEND,
-      ENEMY
-  };
+  /* Dignities as shown, from dgNeutral to dgEnemy. The grahas above are */
+  /* in the same order as grSun to grKet, so index the tables directly.  */
+
+  char *szDignity[] = { "", "Exalted ", "Debilitated ", "Own ",
+                        "Friend ", "Enemy " };
 
   // For external use
   int eDay;
@@ -168,448 +184,135 @@ real lret[objMax];
   int emonths;
   int eyears;
 
-int getSun(int rasi) 
+predProfession(int asc)
 {
-        switch(rasi) {
-        case 0:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 6:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 4:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 5:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 7:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
-        }
-        return(NEUTRAL);
-}
+            /* For profession */
+        int prof = (asc + 8) % 12; /* Rasi of the 10th house */
+        VedicBody *pvb;
+        int i;
 
-int getMoon(int rasi) 
-{
-        switch(rasi) {
-        case 1:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 7:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 3:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 5:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 6:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
-        }
-        return(NEUTRAL);
-}
+        printf("10th Lord %s is in the ", lord[prof]);
 
-int getMercury(int rasi) 
-{
-        switch(rasi) {
-        case 5:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 11:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 2:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 3:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 7:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
+        if (ivb[pindex[prof]] >= 0) {
+                pvb = &rgvb[ivb[pindex[prof]]];
+                printf("%d House ", pvb->house);
+                printf("%s", szDignity[pvb->dignity]);
+                printf("Navamsa ");
+                printf("%s", szDignity[pvb->dignityNav]);
         }
-        return(NEUTRAL);
-}
 
-int getVenus(int rasi) 
-{
-        switch(rasi) {
-        case 11:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 5:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 2:
-        case 6:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 8:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 7:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
-        }
-        return(NEUTRAL);
-}
+        printf("\n");
 
-int getMars(int rasi) 
-{
-        switch(rasi) {
-        case 9:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 3:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 0:
-        case 7:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 2:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 5:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
-        }
-        return(NEUTRAL);
-}
+        printf("Planets in the 10th House: ");
+        for (i = 0; i < cvb; i++) {
+                pvb = &rgvb[i];
+                if (pvb->rasi != prof || pvb->graha < 0 || pvb->graha > Ketu)
+                        continue;
 
-int getJupiter(int rasi) 
-{
-        switch(rasi) {
-        case 3:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 9:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 8:
-        case 11:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 5:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 7:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
-        }
-        return(NEUTRAL);
-}
+                printf("%s ", plan[pvb->graha]);
 
-int getSaturn(int rasi) 
-{
-        switch(rasi) {
-        case 6:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 0:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 9:
-        case 10:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 1:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 4:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
-        }
-        return(NEUTRAL);
-}
+                printf("%s", szDignity[pvb->dignity]);
 
-int getRahu(int rasi) 
-{
-        switch(rasi) {
-        case 0:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 6:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 4:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 5:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 7:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
         }
-        return(NEUTRAL);
+        printf("\n");
 }
 
-int getKetu(int rasi) 
-{
-        switch(rasi) {
-        case 0:
-                printf("Exalted ");
-                return(EXALTED);
-                break;
-        case 6:
-                printf("Debilitated ");
-                return(DEBILITATED);
-                break;
-        case 4:
-                printf("Own ");
-                return(OWN);
-                break;
-        case 5:
-                printf("Friend ");
-                return(FRIEND);
-                break;
-        case 7:
-                printf("Enemy ");
-                return(ENEMY);
-                break;
-        default:
-                break;
-        }
-        return(NEUTRAL);
-}
 
-getPlanet(int planet, int position)
-{
-        switch (planet) {
-        case 1: /* Sun */
-                getSun(position);
-                break;
-        case 2: /* Moon */
-                getMoon(position);
-                break;
-        case 3: /* Mercury */
-                getMercury(position);
-                break;
-        case 4: /* Venus */
-                getVenus(position);
-                break;
-        case 5: /* Mars */
-                getMars(position);
-                break;
-        case 6: /* Jupiter */
-                getJupiter(position);
-                break;
-        case 7: /* Saturn */
-                getSaturn(position);
-                break;
-        case 8: /* Rahu */
-                getRahu(position);
-                break;
-        case 9: /* Ketu */
-                getKetu(position);
-                break;
-        default:
-                break;
-        }
-}
+/* Start a new Vedic chart, with no bodies placed in it. */
 
-predProfession(int asc)
+void ClearVedic()
 {
-            /* For profession */
-        int prof = (asc + 9);
-        int lo;
-        int lh;
-        int li;
-        int lj;
-
-        if (prof > 12) {
-                prof -= 12;
-        }
-        prof--; /* Index starts at 0 */
-
-        printf("10th Lord %s is in the ", lord[prof]);
-
-        for (li = 0; li < 12; li++) {
-                for (lj = 0; lj < chr[li].count; lj++) {
-                        if (pindex[prof] == chr[li].index[lj]) {
-
-                                lh = li + 1;
-                                lo = lh - asc;
-                                if (lo < 0) {
-                                        lo += 12;
-                                }
-                                printf("%d House ", lo + 1);
-                                break;
-                        }
-                }
-        }
-
-        getPlanet(pindex[prof], lh - 1);
-
-        for (li = 0; li < 12; li++) {
-                for (lj = 0; lj < chr[li].navacount; lj++) {
-                        if (pindex[prof] == chr[li].navaindex[lj]) {
-
-                                lh = li;
-                                /*
-                                lo = lh - asc;
-                                if (lo < 0) {
-                                        lo += 12;
-                                }
-                                printf("%d House ", lo + 1);
-                                */
-                                break;
-                        }
-                }
-        }
-
-        printf("Navamsa ");
-        getPlanet(pindex[prof], lh - 1);
-
-        printf("\n");
+  int i;
 
-        printf("Planets in the 10th House: ");
-        for (lj = 0; lj < chr[prof].count; lj++) {
+  cvb = 0;
+  for (i = 0; i < Pmax; i++)
+    ivb[i] = -1;
+}
 
-                printf("%s ", plan[chr[prof].index[lj]]);
 
-                getPlanet(chr[prof].index[lj], prof);
+/* Place a body in the Vedic chart, given its zodiac position. That's   */
+/* kept in arc seconds as returned by LZodiacSec() for finding the      */
+/* divisions, with the degree and minute shown rounded by IRasiDms().   */
+/* The house and dignity are filled in later by FinishVedic(), once the */
+/* Lagna is known.                                                      */
 
-        }
-        printf("\n");
+VedicBody *PvbAddVedic(graha, sz, chMark, deg)
+int graha;
+char *sz;
+char chMark;
+real deg;
+{
+  VedicBody *pvb = &rgvb[cvb];
+  int s;
+
+  if (graha >= 0)
+    ivb[graha] = cvb;
+  cvb++;
+  sprintf(pvb->sz, "%.5s", sz);
+  pvb->graha = graha;
+  pvb->chMark = chMark;
+  pvb->l = LZodiacSec(deg);
+  pvb->rasi = IRasiDms(deg, &pvb->deg, &pvb->min, &s);
+  pvb->house = 0;
+  pvb->dignity = pvb->dignityNav = dgNeutral;
+  return pvb;
 }
 
-#define MIN (60)
-#define HOUR (MIN * 60)
 
-char *mon[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
-                "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+/* Fill in the houses counted from the Lagna, the nakshatra, pada, and */
+/* navamsa of each body, and the dignity of each graha in its rasi and */
+/* navamsa, once every body has been placed.                           */
 
-real getAsc(long clock, int flag)
+void FinishVedic()
 {
-  extern int predasc;
-  extern float baseTT;
-  extern float baseZZ;
-  real Off = 0.0, vtx;
-  struct tm ctm0;
-  struct tm *ctm;
-  char month[28];
-  char day[28];
-  char year[28];
-  char ltm[28];
-  char *dst;
-  char *lon;
-  char *lat;
-  int tmp;
-
-  if (predasc) {
-        TT = baseTT + flag;
-        ZZ = baseZZ - flag;
-  } else {
-        clock += (HOUR * flag);
-
-        ctm = localtime(&clock);
-
-        strcpy(month, mon[ctm->tm_mon]);
-        sprintf(day, "%d", ctm->tm_mday);
-        sprintf(year, "%d", (ctm->tm_year + 1900));
-        sprintf(ltm, "%02d:%02d:%02d", ctm->tm_hour, ctm->tm_min, ctm->tm_sec);
-        MM = NParseSz(month, pmMon);
-        DD = NParseSz(day, pmDay);
-        YY = NParseSz(year, pmYea);
-        TT = RParseSz(ltm, pmTim);
-        // printf("MM %d DD %d YY %d Time %f\n", MM, DD, YY, TT);
-        if ((flag == 2) || (flag == -1)) {
-            dst = "CST";
-        } else if (flag == 3) {
-            dst = "EST";
-        } else if (flag == -3) {
-            dst = "PST";
-        }
-        ZZ = RParseSz(dst, pmZon);
+  byte rggr[Pmax], rgrasi[Pmax], rgnav[Pmax], rgdg[Pmax], rgdgNav[Pmax],
+    rgnak[objMax+Pmax], rgpada[objMax+Pmax], rgvar[objMax+Pmax];
+  long rgl[objMax+Pmax];
+  VedicBody *pvb;
+  int i, cgr = 0, asc = -1, nNavamsa = 9;
+
+  if (ivb[Lag1] >= 0)
+    asc = rgvb[ivb[Lag1]].rasi;
+  for (i = 0; i < cvb; i++) {
+    pvb = &rgvb[i];
+    if (asc >= 0)
+      pvb->house = (pvb->rasi - asc + cSign) % cSign + 1;
+    rgl[i] = pvb->l;
   }
 
-  if ((flag == 2) || (flag == -1)) {
-    /* Chicago */
-    lon = "87:39W";
-    lat = "41:51N";
-  } else if (flag == 3) {
-    /* New York */
-    lon = "74:00W";
-    lat = "40:42N";
-  } else if (flag == -3) {
-    /* Sunnyvale */
-    lon = "122:00W";
-    lat = "37:23N";
+  /* Every body's nakshatra, pada, and navamsa are found at once. */
+
+  NakshatraBatch(rgl, cvb, rgnak, rgpada, NULL, NULL);
+  VargaBatch(rgl, cvb, &nNavamsa, 1, rgvar);
+  for (i = 0; i < cvb; i++) {
+    rgvb[i].nak = rgnak[i]; rgvb[i].pada = rgpada[i];
+    rgvb[i].navamsa = rgvar[i];
   }
 
-  OO = RParseSz(lon, pmLon);
-  AA = RParseSz(lat, pmLat);
+  /* So are the grahas' dignities in their rasis and navamsas. */
 
-  // Process Input
-  ProcessInput(1);
+  for (i = Sun; i <= Ketu; i++) if (ivb[i] >= 0) {
+    pvb = &rgvb[ivb[i]];
+    rggr[cgr] = (byte)i;
+    rgrasi[cgr] = (byte)pvb->rasi; rgnav[cgr] = (byte)pvb->navamsa;
+    cgr++;
+  }
+  GrahaDignities(rggr, rgrasi, cgr, rgdg, NULL);
+  GrahaDignities(rggr, rgnav, cgr, rgdgNav, NULL);
+  for (i = 0; i < cgr; i++) {
+    pvb = &rgvb[ivb[rggr[i]]];
+    pvb->dignity = rgdg[i]; pvb->dignityNav = rgdgNav[i];
+  }
+}
 
-  // Compute Variables
-  ComputeVariables(&vtx);
+/* Other cities whose Lagna is listed alongside the chart's own, with */
+/* longitude (west positive) and latitude in decimal degrees.         */
 
-  // Return the Ascendant
-  return(CuspAscendant());
-}
+enum { cityChicago, cityNewYork, citySunnyvale, cCity };
+
+CONST real rgCityLon[cCity] = { 87.0+39.0/60.0, 74.0, 122.0 };
+CONST real rgCityLat[cCity] = { 41.0+51.0/60.0, 40.0+42.0/60.0,
+  37.0+23.0/60.0 };
 
 #endif
 
@@ -623,62 +326,31 @@ void ChartListing()
 #ifdef LOGAN
   int li;
   int lj;
-  char zod[4];
-  int deg;
-  int min;
-  int sec;
-  int sunrasi;
-  int sundeg;
-  int sunmin;
-  int moonrasi;
-  int moondeg;
-  int moonmin;
-  int mercrasi;
-  int mercdeg;
-  int mercmin;
-  int venurasi;
-  int venudeg;
-  int venumin;
-  int marsrasi;
-  int marsdeg;
-  int marsmin;
-  int jupirasi;
-  int jupideg;
-  int jupimin;
-  int saturasi;
-  int satudeg;
-  int satumin;
-  int rahurasi;
-  int rahudeg;
-  int rahumin;
-  int keturasi;
-  int ketudeg;
-  int ketumin;
-  int asc1rasi;
-  int asc1deg;
-  int asc1min;
+  int graha;
   int asc;
-  int asc2rasi;
-  int asc2deg;
-  int asc2min;
-  int asc3rasi;
-  int asc3deg;
-  int asc3min;
-  int dum;
-  int dum1;
-  int dum2;
-  char ddeg[12];
+  char ch;
   char lag1[6];
-  char lag2[6];
-  char lag3[6];
+  NK nk;
+  VedicBody *pvb;
   extern int matchdata;
 
+  /* For -! just give the Moon, and the nakshatra, rasi, and pada it's in, */
+  /* which is all horoscope matching needs to store for each profile.      */
+
   if (matchdata) {
-      printf("%f\n", planet[oMoo]);
+      NakshatraOf(LZodiacSec(planet[oMoo]), &nk);
+      printf("%f %d %d %d\n", planet[oMoo], nk.nak, nk.rasi + 1, nk.pada);
       return;
   }
 #endif
 
+  /* With -~ just give the chart to the output sink, rather than a table. */
+
+  if (FSink()) {
+    SinkChart();
+    return;
+  }
+
   CreateElemTable(&et);
   fNam = *ciMain.nam > chNull; fLoc = *ciMain.loc > chNull;
 
@@ -740,6 +412,13 @@ void ChartListing()
 
   /* Ok, now print out the location of each object. */
 
+#ifdef LOGAN
+  ClearVedic();
+  if (!regular)
+    sprintf(lag1, "Lag%c", ciMain.loc[0]);
+  else
+    sprintf(lag1, "Lag");
+#endif
   for (i = 1, j = 1; i <= oNorm; i++, j++) {
     if (us.fSeconds) {
       if (ignore[i])
@@ -756,167 +435,33 @@ void ChartListing()
       if (i > oCore)
         j = i;
 #ifdef LOGAN
-      {
-        static int flag = 0;
-        if (flag == 0)
-        {
-          flag = 1;
-          strcpy(chr[0].name, "Ari");
-          strcpy(chr[1].name, "Tau");
-          strcpy(chr[2].name, "Gem");
-          strcpy(chr[3].name, "Can");
-          strcpy(chr[4].name, "Leo");
-          strcpy(chr[5].name, "Vir");
-          strcpy(chr[6].name, "Lib");
-          strcpy(chr[7].name, "Sco");
-          strcpy(chr[8].name, "Sag");
-          strcpy(chr[9].name, "Cap");
-          strcpy(chr[10].name, "Aqu");
-          strcpy(chr[11].name, "Pis");
-          for (li = 0; li < 12; li++)
-          {
-            chr[li].count = 0;
-            chr[li].navacount = 0;
-            for (lj = 0; lj < 8; lj++)
-            {
-              chr[li].planet[lj][0] = '\0';
-              chr[li].navamsam[lj][0] = '\0';
-              chr[li].deg[lj][0] = '\0';
-              chr[li].mdeg[lj][0] = '\0';
-            }
-          }
-        }
-        if (strncmp(szObjName[j], "Ketu", 4) == 0)
-          continue;
+      if (j == oSou)
+        continue;
 
-        sscanf(SzZodiac(planet[j]), "%d%3s%d", &deg, zod, &min);
-        strcpy(ddeg, SzDegree(planet[j]));
-        if (strlen(ddeg) > 7)
-          sscanf(&ddeg[7], "%02d", &sec);
-        else
-          sec = 0;
-        for (li = 0; li < 12; li++)
-        {
-          if (strcmp(chr[li].name, zod) == 0)
-          {
-            sprintf(chr[li].planet[chr[li].count], "%-4.4s", szObjName[j]);
-            if (strcmp(chr[li].planet[chr[li].count], "Sun ") == 0)
-            {
-              sunrasi = li + 1;
-              sundeg = deg;
-              sunmin = min;
-              chr[li].index[chr[li].count] = 1;
-              ind[Rasi][Sun].index = li;
-            }
-            else
-            if (strcmp(chr[li].planet[chr[li].count], "Moon") == 0)
-            {
-              moonrasi = li + 1;
-              moondeg = deg;
-              moonmin = min;
-              chr[li].index[chr[li].count] = 2;
-              ind[Rasi][Moon].index = li;
-            }
-            else
-            if (strcmp(chr[li].planet[chr[li].count], "Merc") == 0)
-            {
-              mercrasi = li + 1;
-              mercdeg = deg;
-              mercmin = min;
-              chr[li].index[chr[li].count] = 3;
-              ind[Rasi][Mercury].index = li;
-            }
-            else
-            if (strcmp(chr[li].planet[chr[li].count], "Venu") == 0)
-            {
-              venurasi = li + 1;
-              venudeg = deg;
-              venumin = min;
-              chr[li].index[chr[li].count] = 4;
-              ind[Rasi][Venus].index = li;
-            }
-            else
-            if (strcmp(chr[li].planet[chr[li].count], "Mars") == 0)
-            {
-              marsrasi = li + 1;
-              marsdeg = deg;
-              marsmin = min;
-              chr[li].index[chr[li].count] = 5;
-              ind[Rasi][Mars].index = li;
-            }
-            else
-            if (strcmp(chr[li].planet[chr[li].count], "Jupi") == 0)
-            {
-              jupirasi = li + 1;
-              jupideg = deg;
-              jupimin = min;
-              chr[li].index[chr[li].count] = 6;
-              ind[Rasi][Jupiter].index = li;
-            }
-            if (strcmp(chr[li].planet[chr[li].count], "Satu") == 0)
-            {
-              saturasi = li + 1;
-              satudeg = deg;
-              satumin = min;
-              chr[li].index[chr[li].count] = 7;
-              ind[Rasi][Saturn].index = li;
-            }
-            else
-            if (strcmp(chr[li].planet[chr[li].count], "Lagn") == 0)
-            {
-              asc1rasi = li + 1;
-              asc1deg = deg;
-              asc1min = min;
-              asc = li + 1;
-              if (!regular) {
-                sprintf(lag1, "Lag%c", ciMain.loc[0]);
-              } else {
-                sprintf(lag1, "Lag");
-              }
-              strcpy(chr[li].planet[chr[li].count], lag1);
-              ind[Rasi][Lag1].index = li;
-            }
-            if (secstrue)
-              sprintf(chr[li].deg[chr[li].count], "[%02d:%02d:%02d]", deg, min, sec);
-            else
-              sprintf(chr[li].deg[chr[li].count], "%02d:%02d", deg, min);
-            sprintf(chr[li].mdeg[chr[li].count], "%02d:%02d", deg, min);
-            if (strcmp(chr[li].planet[chr[li].count], "Rahu") == 0)
-            {
-              strcpy(chr[li].planet[chr[li].count], "Rahu   ");
-              rahurasi = li + 1;
-              rahudeg = deg;
-              rahumin = min;
-              chr[li].index[chr[li].count] = 8;
-              ind[Rasi][Rahu].index = li;
-              if (li >= 6)
-                lj = li - 6;
-              else
-                lj = li + 6;
-              strcpy(chr[lj].planet[chr[lj].count], "Ketu   ");
-              keturasi = lj + 1;
-              ketudeg = deg;
-              ketumin = min;
-              chr[lj].index[chr[lj].count] = 9;
-              ind[Rasi][Ketu].index = lj;
-              if (secstrue)
-                sprintf(chr[lj].deg[chr[lj].count], "[%02d:%02d:%02d]", deg, min, sec);
-              else
-                sprintf(chr[lj].deg[chr[lj].count], "%02d:%02d", deg, min);
-              sprintf(chr[lj].mdeg[chr[lj].count], "%02d:%02d", deg, min);
-              chr[lj].count++;
-            }
-            else if (ret[j] < 0.0)
-              strcat(chr[li].planet[chr[li].count], "(R)");
-            else if ((j != oAsc) && ((DFromR(fabs(ret[j])) / lret[j]) >= 2.0))
-              strcat(chr[li].planet[chr[li].count], "(F)");
-            else
-              strcat(chr[li].planet[chr[li].count], "   ");
-            chr[li].count++;
-            break;
-          }
-        }
-      }
+      /* Place the object in the Vedic chart, along with Ketu opposite */
+      /* Rahu. Only the Sun through Saturn, Rahu, and the Lagna count  */
+      /* as grahas; any other unrestricted objects are just listed.    */
+
+      if (j >= oSun && j <= oSat)
+        graha = Sun + j - oSun;
+      else if (j == oNod)
+        graha = Rahu;
+      else if (j == oAsc)
+        graha = Lag1;
+      else
+        graha = -1;
+      if (graha == Rahu)
+        ch = ' ';
+      else if (ret[j] < 0.0)
+        ch = 'R';
+      else if ((j != oAsc) && ((DFromR(fabs(ret[j])) / lret[j]) >= 2.0))
+        ch = 'F';
+      else
+        ch = ' ';
+      pvb = PvbAddVedic(graha, graha == Lag1 ? lag1 :
+        (graha >= 0 ? szGraha[graha] : szObjName[j]), ch, planet[j]);
+      if (graha == Rahu)
+        PvbAddVedic(Ketu, szGraha[Ketu], ' ', Mod(planet[j] + rDegHalf));
 #else
       AnsiColor(kObjA[j]);
       sprintf(sz, "%-4.4s: ", szObjName[j]); PrintSz(sz);
@@ -999,108 +544,28 @@ void ChartListing()
 #ifdef LOGAN
   if (!regular)
   {
-    real rasc;
-    struct tm ltm;
-    long lclock;
-    long clock;
-    int flag1 = 0;
-    int flag2 = 0;
-
-    time(&clock);
-    
-    memset(&ltm, 0, sizeof(struct tm));
-    ltm.tm_min = (int)(RFract(RAbs(Tim)) * 100.0 + rRound / 60.0);
-    ltm.tm_hour = NFloor(Tim);
-    ltm.tm_mday = Day;
-    ltm.tm_mon = Mon - 1;
-    ltm.tm_year = Yea - 1900;
-    ltm.tm_isdst = SS;
-
-    lclock = mktime(&ltm);
-
-    if ((Lon == 122.00) && (Lat == 37.23)) { /* Sunnyvale */
-        // Asc 2 is Chicago
-        // Asc 3 is New York 
-        flag1 = 2;
-        flag2 = 3;
-    } else {
-        // Asc 2 is Chicago
-        // Asc 3 is Sunnyvale
-        flag1 = -1;
-        flag2 = -3;
-    }
+    extern int predasc;
+    extern float baseTT;
+    extern float baseZZ;
+    real jd, rgasc[cCity], rgmc[cCity];
 
-    // printf("Lon %f Lat %f\n", OO, AA);
+    /* The other Lagnas are for the same moment as the chart, or with -5 */
+    /* for the time of day the switch was given on the chart's date.     */
 
-    // Asc 2 is Chicago
-    rasc = getAsc(lclock, flag1);
-    sscanf(SzZodiac(rasc), "%d%3s%d", &deg, zod, &min);
-    strcpy(ddeg, SzDegree(rasc));
-    if (strlen(ddeg) > 7)
-      sscanf(&ddeg[7], "%02d", &sec);
+    if (predasc)
+      jd = MdytszToJulian(Mon, Day, Yea, baseTT, Dst, baseZZ) - rRound;
     else
-      sec = 0;
-    for (li = 0; li < 12; li++)
-    {
-      if (strcmp(chr[li].name, zod) == 0)
-      {
-        asc2rasi = li + 1;
-        asc2deg = deg;
-        asc2min = min;
-        strcpy(lag2, "LagC");
-        sprintf(chr[li].planet[chr[li].count], "%-4.4s", "LagC");
-        if (secstrue)
-          sprintf(chr[li].deg[chr[li].count], "[%02d:%02d:%02d]", deg, min, sec);
-        else
-          sprintf(chr[li].deg[chr[li].count], "%02d:%02d", deg, min);
-        sprintf(chr[li].mdeg[chr[li].count], "%02d:%02d", deg, min);
-        chr[li].count++;
-        ind[Rasi][Lag2].index = li;
-        break;
-      }
-    }
- 
-    rasc = getAsc(lclock, flag2);
-    sscanf(SzZodiac(rasc), "%d%3s%d", &deg, zod, &min);
-    strcpy(ddeg, SzDegree(rasc));
-    if (strlen(ddeg) > 7)
-      sscanf(&ddeg[7], "%02d", &sec);
+      jd = JulianDayFromTime(T);
+    CastHouseBatch(jd, rgCityLon, rgCityLat, cCity, rgasc, rgmc, NULL);
+
+    PvbAddVedic(Lag2, "LagC", chNull, rgasc[cityChicago]);
+    if ((Lon == 122.00) && (Lat == 37.23))    /* Sunnyvale */
+        PvbAddVedic(Lag3, "LagN", chNull, rgasc[cityNewYork]);
     else
-      sec = 0;
-    for (li = 0; li < 12; li++)
-    {
-      if (strcmp(chr[li].name, zod) == 0)
-      {
-        asc3rasi = li + 1;
-        asc3deg = deg;
-        asc3min = min;
-        if (flag2 == 3) {
-            strcpy(lag3, "LagN");
-        } else {
-            strcpy(lag3, "LagS");
-        }
-        sprintf(chr[li].planet[chr[li].count], "%-4.4s", lag3);
-        if (secstrue)
-          sprintf(chr[li].deg[chr[li].count], "[%02d:%02d:%02d]", deg, min, sec);
-        else
-          sprintf(chr[li].deg[chr[li].count], "%02d:%02d", deg, min);
-        sprintf(chr[li].mdeg[chr[li].count], "%02d:%02d", deg, min);
-        chr[li].count++;
-        ind[Rasi][Lag3].index = li;
-        break;
-      }
-    }
+        PvbAddVedic(Lag3, "LagS", chNull, rgasc[citySunnyvale]);
   }
-
-#define SUN     0
-#define MOON    1
-#define MARS    2
-#define RAHU    3
-#define JUPITER 4
-#define SATURN  5
-#define MERCURY 6
-#define KETU    7
-#define VENUS   8
+  FinishVedic();
+  asc = ivb[Lag1] >= 0 ? rgvb[ivb[Lag1]].rasi + 1 : 0;
 
   {
     int ruler;
@@ -1112,11 +577,13 @@ void ChartListing()
     char *fmt1;
     char *fmt2;
 
-    getRuler("Moon", Moon,  moonrasi, moondeg, moonmin, &ruler, &days, &months, &years, navamsam);
+    ruler = days = months = years = 0;
+    if (ivb[Moon] >= 0)
+      getRuler(&rgvb[ivb[Moon]], &ruler, &days, &months, &years, navamsam);
 
     {
       if (is.szFile != NULL) {
-        DasaMain(is.szFile, Day, Mon, Yea, ruler, days, months, years);
+        DasaMain(is.szFile, JulianDayFromTime(T), planet[oMoo]);
       } else {
         extern int exportDesa;
         // For external use
@@ -1126,21 +593,12 @@ void ChartListing()
         }
       }
 
-      getRuler("Sun", Sun, sunrasi, sundeg, sunmin, NULL, NULL, NULL, NULL, regular && navamsam);
-      getRuler("Merc", Mercury, mercrasi, mercdeg, mercmin, NULL, NULL, NULL, NULL, regular && navamsam);
-      getRuler("Venu", Venus, venurasi, venudeg, venumin, NULL, NULL, NULL, NULL, regular && navamsam);
-      if (regular && navamsam) printf("\n"); 
-      getRuler("Mars", Mars, marsrasi, marsdeg, marsmin, NULL, NULL, NULL, NULL, regular && navamsam);
-      getRuler("Jupi", Jupiter, jupirasi, jupideg, jupimin, NULL, NULL, NULL, NULL, regular && navamsam);
-      getRuler("Satu", Saturn, saturasi, satudeg, satumin, NULL, NULL, NULL, NULL, regular && navamsam);
-      if (regular && navamsam) printf("\n"); 
-      getRuler("Rahu", Rahu, rahurasi, rahudeg, rahumin, NULL, NULL, NULL, NULL, regular && navamsam);
-      getRuler("Ketu", Ketu, keturasi, ketudeg, ketumin, NULL, NULL, NULL, NULL, regular && navamsam);
-      getRuler(lag1, Lag1, asc1rasi, asc1deg, asc1min, NULL, NULL, NULL, NULL, regular && navamsam);
-      if (regular && navamsam) printf("\n"); 
-      if (!regular) {
-        getRuler(lag2, Lag2, asc2rasi, asc2deg, asc2min, NULL, NULL, NULL, NULL, regular && navamsam);
-        getRuler(lag3, Lag3, asc3rasi, asc3deg, asc3min, NULL, NULL, NULL, NULL, regular && navamsam);
+      for (li = 1; li < Pmax; li++) {
+        graha = rgAmsaOrder[li];
+        if (ivb[graha] >= 0)
+          getRuler(&rgvb[ivb[graha]], NULL, NULL, NULL, NULL,
+            regular && navamsam);
+        if (li % 3 == 0 && regular && navamsam) printf("\n");
       }
     }
     if (!regular && (csv == 0)) {
@@ -1162,108 +620,83 @@ void ChartListing()
       tret = DFromR(fabs(ret[16])) / lret[16];
       printf("%-4.4s%-3.3s %4.2f\n", szObjName[16], "   ", tret);
     }
-    /*
-    if (regular)
-    {
-      if (secstrue) {
-        dst1 = " ----------------------------------------------------------------------- \n";
-        dst2 = " -----------------                                     ----------------- \n";
-        fmt1 = "|%7s%10s|%7s%10s|%7s%10s|%7s%10s|\n";
-        fmt2 = "|%7s%10s|%7s%10s %7s%10s|%7s%10s|\n";
-      }
-      else {
-        dst1 = " --------------------------------------------------- \n";
-        dst2 = " ------------                           ------------ \n";
-        fmt1 = "|%7s%5s|%7s%5s|%7s%5s|%7s%5s|\n";
-        fmt2 = "|%7s%5s|%7s%5s %7s%5s|%7s%5s|\n";
-      }
-      printf("\n");
-      printf("%s", dst1);
-      for (lj = 0; lj < 8; lj++)
-      {
-        printf(fmt1, 
-               chr[11].planet[lj], chr[11].deg[lj], 
-               chr[0].planet[lj], chr[0].deg[lj],
-               chr[1].planet[lj], chr[1].deg[lj],
-               chr[2].planet[lj], chr[2].deg[lj]);
-      }
-      printf("%s", dst1);
-      for (lj = 0; lj < 8; lj++)
-      {
-        printf(fmt2, 
-               chr[10].planet[lj], chr[10].deg[lj], 
-               "", "",
-               "", "",
-               chr[3].planet[lj], chr[3].deg[lj]);
-      }
-      printf("%s", dst2);
-      for (lj = 0; lj < 8; lj++)
-      {
-        printf(fmt2, 
-               chr[9].planet[lj], chr[9].deg[lj], 
-               "", "",
-               "", "",
-               chr[4].planet[lj], chr[4].deg[lj]);
-      }
-      printf("%s", dst1);
-      for (lj = 0; lj < 8; lj++)
-      {
-        printf(fmt1, 
-               chr[8].planet[lj], chr[8].deg[lj], 
-               chr[7].planet[lj], chr[7].deg[lj],
-               chr[6].planet[lj], chr[6].deg[lj],
-               chr[5].planet[lj], chr[5].deg[lj]);
-      }
-      printf("%s", dst1);
-      printf("\n"); 
-    }
-    */
-
-    if (predictor) {
+    if (predictor && asc > 0) {
             predProfession(asc);
     }
 
     if (navamsam)
     {
+      char szCell[cSign][8][12];
+      char szDeg[cSign][8][6];
+      char szAmsa[cSign][8][6];
+      int cCell[cSign];
+      int cAmsa[cSign];
+
+      ClearB((lpbyte)szCell, sizeof(szCell));
+      ClearB((lpbyte)szDeg, sizeof(szDeg));
+      ClearB((lpbyte)szAmsa, sizeof(szAmsa));
+      for (li = 0; li < cSign; li++)
+        cCell[li] = cAmsa[li] = 0;
+      for (li = 0; li < cvb; li++) {
+        pvb = &rgvb[li];
+        if (cCell[pvb->rasi] >= 8)
+          continue;
+        lj = cCell[pvb->rasi]++;
+        if (pvb->chMark == chNull)
+          sprintf(szCell[pvb->rasi][lj], "%-4.4s", pvb->sz);
+        else if (pvb->chMark == ' ')
+          sprintf(szCell[pvb->rasi][lj], "%-4.4s   ", pvb->sz);
+        else
+          sprintf(szCell[pvb->rasi][lj], "%-4.4s(%c)", pvb->sz, pvb->chMark);
+        sprintf(szDeg[pvb->rasi][lj], "%02d:%02d", pvb->deg, pvb->min);
+      }
+      for (li = 0; li < Pmax; li++) {
+        if (ivb[rgAmsaOrder[li]] < 0)
+          continue;
+        pvb = &rgvb[ivb[rgAmsaOrder[li]]];
+        if (cAmsa[pvb->navamsa] < 8)
+          strcpy(szAmsa[pvb->navamsa][cAmsa[pvb->navamsa]++], pvb->sz);
+      }
+
       dst1 = " ---------------------------------------------------        ----------------------- \n";
       dst2 = " ------------           Rasi            ------------        -----    Amsam    ----- \n";
       printf("\n%s", dst1);
       for (lj = 0; lj < 8; lj++)
       {
-        printf("|%-7s%5s|%-7s%5s|%-7s%5s|%-7s%5s|", chr[11].planet[lj], chr[11].mdeg[lj],
-                chr[0].planet[lj], chr[0].mdeg[lj],
-                  chr[1].planet[lj], chr[1].mdeg[lj],
-                chr[2].planet[lj], chr[2].mdeg[lj]);
-        printf("      |%-5s|%-5s|%-5s|%-5s|\n", chr[11].navamsam[lj], chr[0].navamsam[lj], 
-                  chr[1].navamsam[lj], chr[2].navamsam[lj]);
+        printf("|%-7s%5s|%-7s%5s|%-7s%5s|%-7s%5s|", szCell[11][lj], szDeg[11][lj],
+                szCell[0][lj], szDeg[0][lj],
+                  szCell[1][lj], szDeg[1][lj],
+                szCell[2][lj], szDeg[2][lj]);
+        printf("      |%-5s|%-5s|%-5s|%-5s|\n", szAmsa[11][lj], szAmsa[0][lj], 
+                  szAmsa[1][lj], szAmsa[2][lj]);
       }
       printf("%s", dst1);
       for (lj = 0; lj < 8; lj++)
       {
-        printf("|%-7s%5s|%-7s%5s %-7s%5s|%-7s%5s|", chr[10].planet[lj], chr[10].mdeg[lj],
+        printf("|%-7s%5s|%-7s%5s %-7s%5s|%-7s%5s|", szCell[10][lj], szDeg[10][lj],
                 "", "", "", "", 
-                  chr[3].planet[lj], chr[3].mdeg[lj]);
-        printf("      |%-5s|%-5s %-5s|%-5s|\n", chr[10].navamsam[lj], "", "", 
-                  chr[3].navamsam[lj]);
+                  szCell[3][lj], szDeg[3][lj]);
+        printf("      |%-5s|%-5s %-5s|%-5s|\n", szAmsa[10][lj], "", "", 
+                  szAmsa[3][lj]);
       }
       printf("%s", dst2);
       for (lj = 0; lj < 8; lj++)
       {
-        printf("|%-7s%5s|%-7s%5s %-7s%5s|%-7s%5s|", chr[9].planet[lj], chr[9].mdeg[lj],
+        printf("|%-7s%5s|%-7s%5s %-7s%5s|%-7s%5s|", szCell[9][lj], szDeg[9][lj],
                 "", "", "", "",
-               chr[4].planet[lj], chr[4].mdeg[lj]);
-        printf("      |%-5s|%-5s %-5s|%-5s|\n", chr[9].navamsam[lj], "", "",
-               chr[4].navamsam[lj]);
+               szCell[4][lj], szDeg[4][lj]);
+        printf("      |%-5s|%-5s %-5s|%-5s|\n", szAmsa[9][lj], "", "",
+               szAmsa[4][lj]);
       }
       printf("%s", dst1);
       for (lj = 0; lj < 8; lj++)
       {
-        printf("|%-7s%5s|%-7s%5s|%-7s%5s|%-7s%5s|", chr[8].planet[lj], chr[8].mdeg[lj],
-                chr[7].planet[lj], chr[7].mdeg[lj],
-                chr[6].planet[lj], chr[6].mdeg[lj],
-                chr[5].planet[lj], chr[5].mdeg[lj]);
-        printf("      |%-5s|%-5s|%-5s|%-5s|\n", chr[8].navamsam[lj], chr[7].navamsam[lj],
-               chr[6].navamsam[lj], chr[5].navamsam[lj]);
+        printf("|%-7s%5s|%-7s%5s|%-7s%5s|%-7s%5s|", szCell[8][lj], szDeg[8][lj],
+                szCell[7][lj], szDeg[7][lj],
+                szCell[6][lj], szDeg[6][lj],
+                szCell[5][lj], szDeg[5][lj]);
+        printf("      |%-5s|%-5s|%-5s|%-5s|\n", szAmsa[8][lj], szAmsa[7][lj],
+               szAmsa[6][lj], szAmsa[5][lj]);
       }
       printf("%s", dst1);
       printf("\n");
@@ -1274,7 +707,13 @@ void ChartListing()
         printf("%02d:%02d", NFloor(Tim), (int)(RFract(RAbs(Tim)) * 100.0 + rRound / 60.0));
         for (ki = 0; ki < Smax; ki++) {
             for (kj = 0; kj < Pmax; kj++) {
-                printf(",%s", chr[ind[ki][kj].index].name);
+                if (ivb[kj] < 0) {
+                    printf(",");
+                    continue;
+                }
+                pvb = &rgvb[ivb[kj]];
+                lj = (ki == Rasi ? pvb->rasi : pvb->navamsa) + 1;
+                printf(",%c%c%c", chSig3(lj));
             }
         }
         printf("\n");
@@ -1377,602 +816,35 @@ void ChartListing()
 
 #ifdef LOGAN
 
-getRuler(plannet, index, rasi, deg, min, ruler, days, months, years, flag)
-char *plannet;
-int index;
-int rasi;
-int deg;
-int min;
+/* Find the nakshatra and pada of a body in the Vedic chart. For the Moon */
+/* also return the dasa lord and the balance of its dasa at birth, and if */
+/* the flag is set print the rasi and nakshatra along with the balance.   */
+/* For other bodies just print the nakshatra and pada, if the flag's set. */
+
+getRuler(pvb, ruler, days, months, years, flag)
+VedicBody *pvb;
 int *ruler;
 int *days;
 int *months;
 int *years;
 {
-  int actualmin = 0;
-  int remainmin = 0;
-  int moonflag = 0;
-  int padam = 0;
-  char star[24];
-  int offset = 0;
-
-  if (strcmp(plannet, "Moon") == 0) {
-    moonflag = 1;
+  NK nk;
+
+  if (pvb->graha != Moon) {
+    if (flag)
+      printf("%-4s %10s(%d)  ", pvb->sz, naksatras[pvb->nak], pvb->pada);
+    return;
   }
-  actualmin = deg * 60 + min;
-  switch(rasi)
-  {
-    case 1:
-      if (moonflag)
-        if (flag) printf("Rasi: Mesham, ");
-      if (actualmin >= 0 && actualmin < 800)
-      { 
-        padam = (actualmin / 200) + 1;
-        strcpy(star, "Aswini");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Ketu ", star, padam);
-          remainmin = 800 - actualmin; 
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = KETU;
-        }
-      }
-      else
-      if (actualmin >= 800 && actualmin < 1600)
-      {
-        padam = ((actualmin - 800) / 200) + 1;
-        strcpy(star, "Bharani");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Venus ", star, padam);
-          remainmin = 1600 - actualmin;
-          getBalance(remainmin, years, months, days, 20);
-          *ruler = VENUS;
-        }
-      }
-      else
-      if (actualmin >= 1600 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1600) / 200) + 1;
-        strcpy(star, "Krithikai");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Sun ", star, padam);
-          remainmin = 2400 - actualmin;
-          getBalance(remainmin, years, months, days, 6);
-          *ruler = SUN;
-        }
-      }
-      break;
-    case 2:
-      if (moonflag)
-        if (flag) printf("Rasi: Vrishabham, ");
-      if (actualmin >= 0 && actualmin < 600)
-      {
-        padam = (actualmin / 200) + 2;
-        strcpy(star, "Krithikai");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Sun ", star, padam);
-          remainmin = 600 - actualmin;
-          getBalance(remainmin, years, months, days, 6);
-          *ruler = SUN;
-        }
-      }
-      else
-      if (actualmin >= 600 && actualmin < 1400)
-      {
-        padam = ((actualmin - 600) / 200) + 1;
-        strcpy(star, "Rohini");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Moon ", star, padam);
-          remainmin = 1400 - actualmin;
-          getBalance(remainmin, years, months, days, 10);
-          *ruler = MOON;
-        }
-      }
-      else
-      if (actualmin >= 1400 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1400) / 200) + 1;
-        strcpy(star, "Mrigashir");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mars ", star, padam);
-          remainmin = 2200 - actualmin;
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = MARS;
-        }
-      }
-      break;
-    case 3:
-      if (moonflag)
-        if (flag) printf("Rasi: Mithunam, ");
-      if (actualmin >= 0 && actualmin < 400)
-      { 
-        padam = (actualmin / 200) + 3;
-        strcpy(star, "Mrigashir");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mars ", star, padam);
-          remainmin = 400 - actualmin;
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = MARS;
-        }
-      }
-      else
-      if (actualmin >= 400 && actualmin < 1200)
-      {
-        padam = ((actualmin - 400) / 200) + 1;
-        strcpy(star, "Thiruvadu");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Rahu ", star, padam);
-          remainmin = 1200 - actualmin;
-          getBalance(remainmin, years, months, days, 18);
-          *ruler = RAHU;
-        }
-      }
-      else
-      if (actualmin >= 1200 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1200) / 200) + 1;
-        strcpy(star, "Punrpusam");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Jupiter ", star, padam);
-          remainmin = 2000 - actualmin;
-          getBalance(remainmin, years, months, days, 16);
-          *ruler = JUPITER;
-        }
-      }
-      break;
-    case 4:
-      if (moonflag)
-        if (flag) printf("Rasi: Katakam, ");
-      if (actualmin >= 0 && actualmin < 200)
-      { 
-        padam = (actualmin / 200) + 4;
-        strcpy(star, "Punrpusam");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Jupiter ", star, padam);
-          remainmin = 200 - actualmin;
-          getBalance(remainmin, years, months, days, 16);
-          *ruler = JUPITER;
-        }
-      }
-      else
-      if (actualmin >= 200 && actualmin < 1000)
-      {
-        padam = ((actualmin - 200) / 200) + 1;
-        strcpy(star, "Pusam");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Saturn ", star, padam);
-          remainmin = 1000 - actualmin;
-          getBalance(remainmin, years, months, days, 19);
-          *ruler = SATURN;
-        }
-      }
-      else
-      if (actualmin >= 1000 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1000) / 200) + 1;
-        strcpy(star, "Ayilyam");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mercury ", star, padam);
-          remainmin = 1800 - actualmin;
-          getBalance(remainmin, years, months, days, 17);
-          *ruler = MERCURY;
-        }
-      }
-      break;
-    case 5:
-      if (moonflag)
-        if (flag) printf("Rasi: Simham, ");
-      if (actualmin >= 0 && actualmin < 800)
-      { 
-        padam = (actualmin / 200) + 1;
-        strcpy(star, "Magham");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Ketu ", star, padam);
-          remainmin = 800 - actualmin;
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = KETU;
-        }
-      }
-      else
-      if (actualmin >= 800 && actualmin < 1600)
-      {
-        padam = ((actualmin - 800) / 200) + 1;
-        strcpy(star, "Puram");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Venus ", star, padam);
-          remainmin = 1600 - actualmin;
-          getBalance(remainmin, years, months, days, 20);
-          *ruler = VENUS;
-        }
-      }
-      else
-      if (actualmin >= 1600 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1600) / 200) + 1;
-        strcpy(star, "Uttaram");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Sun ", star, padam);
-          remainmin = 2400 - actualmin;
-          getBalance(remainmin, years, months, days, 6);
-          *ruler = SUN;
-        }
-      }
-      break;
-    case 6:
-      if (moonflag)
-        if (flag) printf("Rasi: Kanya, ");
-      if (actualmin >= 0 && actualmin < 600)
-      {
-        padam = (actualmin / 200) + 2;
-        strcpy(star, "Uttaram");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Sun ", star, padam);
-          remainmin = 600 - actualmin;
-          getBalance(remainmin, years, months, days, 6);
-          *ruler = SUN;
-        }
-      }
-      else
-      if (actualmin >= 600 && actualmin < 1400)
-      {
-        padam = ((actualmin - 600) / 200) + 1;
-        strcpy(star, "Hastam");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Moon ", star, padam);
-          remainmin = 1400 - actualmin;
-          getBalance(remainmin, years, months, days, 10);
-          *ruler = MOON;
-        }
-      }
-      else
-      if (actualmin >= 1400 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1400) / 200) + 1;
-        strcpy(star, "Chitrai");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mars ", star, padam);
-          remainmin = 2200 - actualmin;
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = MARS;
-        }
-      }
-      break;
-    case 7:
-      if (moonflag)
-        if (flag) printf("Rasi: Tulam, ");
-      if (actualmin >= 0 && actualmin < 400)
-      { 
-        padam = (actualmin / 200) + 3;
-        strcpy(star, "Chitrai");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mars ", star, padam);
-          remainmin = 400 - actualmin;
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = MARS;
-        }
-      }
-      else
-      if (actualmin >= 400 && actualmin < 1200)
-      {
-        padam = ((actualmin - 400) / 200) + 1;
-        strcpy(star, "Swati");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Rahu ", star, padam);
-          remainmin = 1200 - actualmin;
-          getBalance(remainmin, years, months, days, 18);
-          *ruler = RAHU;
-        }
-      }
-      else
-      if (actualmin >= 1200 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1200) / 200) + 1;
-        strcpy(star, "Vishakham");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Jupiter ", star, padam);
-          remainmin = 2000 - actualmin;
-          getBalance(remainmin, years, months, days, 16);
-          *ruler = JUPITER;
-        }
-      }
-      break;
-    case 8:
-      if (moonflag)
-        if (flag) printf("Rasi: Vrishchikam, ");
-      if (actualmin >= 0 && actualmin < 200)
-      { 
-        padam = (actualmin / 200) + 4;
-        strcpy(star, "Vishakham");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Jupiter ", star, padam);
-          remainmin = 200 - actualmin;
-          getBalance(remainmin, years, months, days, 16);
-          *ruler = JUPITER;
-        }
-      }
-      else
-      if (actualmin >= 200 && actualmin < 1000)
-      {
-        padam = ((actualmin - 200) / 200) + 1;
-        strcpy(star, "Anusham");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Saturn ", star, padam);
-          remainmin = 1000 - actualmin;
-          getBalance(remainmin, years, months, days, 19);
-          *ruler = SATURN;
-        }
-      }
-      else
-      if (actualmin >= 1000 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1000) / 200) + 1;
-        strcpy(star, "Kettai");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mercury ", star, padam);
-          remainmin = 1800 - actualmin;
-          getBalance(remainmin, years, months, days, 17);
-          *ruler = MERCURY;
-        }
-      }
-      break;
-    case 9:
-      if (moonflag)
-        if (flag) printf("Rasi: Dhanus, ");
-      if (actualmin >= 0 && actualmin < 800)
-      { 
-        padam = (actualmin / 200) + 1;
-        strcpy(star, "Mulam");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Ketu ", star, padam);
-          remainmin = 800 - actualmin;
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = KETU;
-        }
-      }
-      else
-      if (actualmin >= 800 && actualmin < 1600)
-      {
-        padam = ((actualmin - 800) / 200) + 1;
-        strcpy(star, "Puradam");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Venus ", star, padam);
-          remainmin = 1600 - actualmin;
-          getBalance(remainmin, years, months, days, 20);
-          *ruler = VENUS;
-        }
-      }
-      else
-      if (actualmin >= 1600 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1600) / 200) + 1;
-        strcpy(star, "Uttaradam");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Sun ", star, padam);
-          remainmin = 2400 - actualmin;
-          getBalance(remainmin, years, months, days, 6);
-          *ruler = SUN;
-        }
-      }
-      break;
-    case 10:
-      if (moonflag)
-        if (flag) printf("Rasi: Makaram, ");
-      if (actualmin >= 0 && actualmin < 600)
-      {
-        padam = (actualmin / 200) + 2;
-        strcpy(star, "Uttaradam");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Sun ", star, padam);
-          remainmin = 600 - actualmin;
-          getBalance(remainmin, years, months, days, 6);
-          *ruler = SUN;
-        }
-      }
-      else
-      if (actualmin >= 600 && actualmin < 1400)
-      {
-        padam = ((actualmin - 600) / 200) + 1;
-        strcpy(star, "Tiruvonam");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Moon ", star, padam);
-          remainmin = 1400 - actualmin;
-          getBalance(remainmin, years, months, days, 10);
-          *ruler = MOON;
-        }
-      }
-      else
-      if (actualmin >= 1400 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1400) / 200) + 1;
-        strcpy(star, "Avitam");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mars ", star, padam);
-          remainmin = 2200 - actualmin;
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = MARS;
-        }
-      }
-      break;
-    case 11:
-      if (moonflag)
-        if (flag) printf("Rasi: Kumbham, ");
-      if (actualmin >= 0 && actualmin < 400)
-      { 
-        padam = (actualmin / 200) + 3;
-        strcpy(star, "Avitam");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mars ", star, padam);
-          remainmin = 400 - actualmin;
-          getBalance(remainmin, years, months, days, 7);
-          *ruler = MARS;
-        }
-      }
-      else
-      if (actualmin >= 400 && actualmin < 1200)
-      {
-        padam = ((actualmin - 400) / 200) + 1;
-        strcpy(star, "Sathayam");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Rahu ", star, padam);
-          remainmin = 1200 - actualmin;
-          getBalance(remainmin, years, months, days, 18);
-          *ruler = RAHU;
-        }
-      }
-      else
-      if (actualmin >= 1200 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1200) / 200) + 1;
-        strcpy(star, "Puratathi");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Jupiter ", star, padam);
-          remainmin = 2000 - actualmin;
-          getBalance(remainmin, years, months, days, 16);
-          *ruler = JUPITER;
-        }
-      }
-      break;
-    case 12:
-      if (moonflag)
-        if (flag) printf("Rasi: Minam, ");
-      if (actualmin >= 0 && actualmin < 200)
-      { 
-        padam = (actualmin / 200) + 4;
-        strcpy(star, "Puratathi");
-        offset = 0;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Jupiter ", star, padam);
-          remainmin = 200 - actualmin;
-          getBalance(remainmin, years, months, days, 16);
-          *ruler = JUPITER;
-        }
-      }
-      else
-      if (actualmin >= 200 && actualmin < 1000)
-      {
-        padam = ((actualmin - 200) / 200) + 1;
-        strcpy(star, "Utartathi");
-        offset = 4;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Saturn ", star, padam);
-          remainmin = 1000 - actualmin;
-          getBalance(remainmin, years, months, days, 19);
-          *ruler = SATURN;
-        }
-      }
-      else
-      if (actualmin >= 1000 && actualmin < 1800)
-      {
-        padam = ((actualmin - 1000) / 200) + 1;
-        strcpy(star, "Revati");
-        offset = 8;
-        if (moonflag)
-        {
-          if (flag) printf("Nakshatram: %s, %d Padam, Mercury ", star, padam);
-          remainmin = 1800 - actualmin;
-          getBalance(remainmin, years, months, days, 17);
-          *ruler = MERCURY;
-        }
-      }
-      break;
+  NakshatraOf(pvb->l, &nk);
+  *ruler = nk.lord;
+  *years = nk.years;
+  *months = nk.months;
+  *days = nk.days;
+  if (flag) {
+    printf("Rasi: %s, Nakshatram: %s, %d Padam, %s ", rasis[nk.rasi],
+      naksatras[nk.nak], nk.pada, szDasaLord[nk.lord]);
+    printf("Dasa Balance %dY %dM %dD\n\n", *years, *months, *days);
   }
-  if (moonflag) {
-    if (flag) printf("Dasa Balance %dY %dM %dD\n\n", *years, *months, *days);
-  } else
-    if (flag) printf("%-4s %10s(%d)  ", plannet, star, padam); 
-
-  chr[(padam - 1) + offset].navaindex[chr[(padam - 1) + offset].navacount] = index;
-  strcpy(chr[(padam - 1) + offset].navamsam[chr[(padam - 1) + offset].navacount++], plannet);
-  ind[Amsa][index].index = ((padam - 1) + offset);
-}
-
-/*
-Get the balance day from degress/min
-*/
-getBalance(remainmin, years, months, days, numyear)
-int remainmin;
-int *years;
-int *months;
-int *days;
-int numyear;
-{
-
-  float val;
-
-  val = remainmin / 800.0 * numyear;
-  *years = (int)val;
-  val = val - *years;
-  val = val * 12;
-  *months = (int)val;
-  val = val - *months; 
-  *days = (int)(val * 30);
-
 }
 
 #endif /* LOGAN */
@@ -2392,26 +1264,26 @@ void ChartAspect()
   char sz[cchSzDef];
   int pcut = 30000, icut, jcut, phi, ihi, jhi, ahi, p, i, j, k, count = 0;
   real ip, jp, rPowSum = 0.0;
+  AspectInfo FPTR *pai, *paihi;
 
   ClearB((lpbyte)ca, (cAspect + 1)*(int)sizeof(int));
   ClearB((lpbyte)co, objMax*(int)sizeof(int));
   loop {
     phi = -1;
 
-    /* Search for the next most powerful aspect in the aspect grid. */
-
-    for (i = 2; i <= cObj; i++) if (!ignore[i])
-      for (j = 1; j < i; j++) if (!ignore[j])
-        if (k = grid->n[j][i]) {
-          ip = i <= oNorm ? rObjInf[i] : 2.5;
-          jp = j <= oNorm ? rObjInf[j] : 2.5;
-          p = (int)(rAspInf[k]*(ip+jp)/2.0*
-            (1.0-RAbs((real)(grid->v[j][i]))/60.0/rAspOrb[k])*1000.0);
-          if ((p < pcut || (p == pcut && (i > icut ||
-            (i == icut && j > jcut)))) && p > phi) {
-            ihi = i; jhi = j; phi = p; ahi = k;
-          }
-        }
+    /* Search for the next most powerful aspect in the aspect list. */
+
+    for (pai = rgai; pai < rgai + cai; pai++) {
+      i = pai->obj2; j = pai->obj1; k = pai->asp;
+      ip = i <= oNorm ? rObjInf[i] : 2.5;
+      jp = j <= oNorm ? rObjInf[j] : 2.5;
+      p = (int)(rAspInf[k]*(ip+jp)/2.0*
+        (1.0-RAbs((real)(pai->nOrb))/60.0/rAspOrb[k])*1000.0);
+      if ((p < pcut || (p == pcut && (i > icut ||
+        (i == icut && j > jcut)))) && p > phi) {
+        ihi = i; jhi = j; phi = p; ahi = k; paihi = pai;
+      }
+    }
     if (phi < 0)    /* Exit when no less powerful aspect found. */
       break;
     pcut = phi; icut = ihi; jcut = jhi;
@@ -2425,10 +1297,14 @@ void ChartAspect()
     rPowSum += (real)phi/1000.0;
     ca[ahi]++;
     co[jhi]++; co[ihi]++;
+    if (FSink()) {
+      SinkAspect(jhi, ahi, ihi, (real)paihi->nOrb/60.0, (real)phi/1000.0);
+      continue;
+    }
     sprintf(sz, "%3d: ", count); PrintSz(sz);
     PrintAspect(jhi, SFromZ(planet[jhi]), (int)RSgn(ret[jhi]), ahi,
       ihi, SFromZ(planet[ihi]), (int)RSgn(ret[ihi]), 'a');
-    k = grid->v[jhi][ihi];
+    k = paihi->nOrb;
     AnsiColor(k < 0 ? kWhite : kLtGray);
     sprintf(sz, " - orb: %c%d%c%02d'",
       us.fAppSep ? (k < 0 ? 'a' : 's') : (k < 0 ? '-' : '+'),
@@ -2441,6 +1317,8 @@ void ChartAspect()
   /* Now, if the -a0 switch is set, display summary information, the total */
   /* number of aspects of each type, and the # of aspects to each object.  */
 
+  if (FSink())
+    return;
   if (!us.fAspSummary) {
     PrintL();
     return;
@@ -3000,11 +1878,15 @@ bool fProg;
     if (is.fMult)
       PrintL2();
     if (us.nRel > rcDual) {
-      if (!fCall) {
+#ifdef INTERPRET
+      if (us.fInterpret && !fCall) {    /* Interpretations use the grid. */
         fCall = fTrue;
         if (!FCreateGrid(fFalse))
           return;
       }
+#endif
+      if (!FCreateAspectList())
+        return;
       ChartAspect();
     } else {
       if (!FCreateGridRelation(fFalse))
@@ -553,31 +553,30 @@ void ChartInDayInfluence()
   int source[MAXINDAY], aspect[MAXINDAY], dest[MAXINDAY];
   real power[MAXINDAY];
   char sz[cchSzDef];
+  int orb[MAXINDAY];
   int occurcount = 0, i, j, k, l, m;
+  AspectInfo FPTR *pai;
 
   /* Go compute the aspects in the chart. */
 
   i = us.fAppSep;
   us.fAppSep = fTrue;     /* We always want applying vs. separating orbs. */
-  FCreateGrid(fFalse);
+  j = FCreateAspectList();
   us.fAppSep = i;
+  if (!j)
+    return;
 
-  /* Search through the grid and build up the list of aspects. */
+  /* Go through the aspects present and compute the power of each. */
 
-  for (j = 2; j <= cObj; j++) {
-    if (ignore[j])
-      continue;
-    for (i = 1; i < j; i++) {
-      if (ignore[i] || (k = grid->n[i][j]) == 0 || occurcount >= MAXINDAY)
-        continue;
-      source[occurcount] = i; aspect[occurcount] = k; dest[occurcount] = j;
-      l = grid->v[i][j];
-      power[occurcount] =
-        ((i <= oNorm ? rTransitInf[i] : 2.0)/4.0)*
-        ((j <= oNorm ? rTransitInf[j] : 2.0)/4.0)*
-        rAspInf[k]*(1.0-(real)abs(l)/60.0/GetOrb(i, j, k));
-      occurcount++;
-    }
+  for (pai = rgai; pai < rgai + cai && occurcount < MAXINDAY; pai++) {
+    i = pai->obj1; k = pai->asp; j = pai->obj2;
+    source[occurcount] = i; aspect[occurcount] = k; dest[occurcount] = j;
+    orb[occurcount] = pai->nOrb;
+    power[occurcount] =
+      ((i <= oNorm ? rTransitInf[i] : 2.0)/4.0)*
+      ((j <= oNorm ? rTransitInf[j] : 2.0)/4.0)*
+      rAspInf[k]*(1.0-(real)abs(pai->nOrb)/60.0/GetOrb(i, j, k));
+    occurcount++;
   }
 
   /* Sort aspects by order of influence. */
@@ -588,6 +587,7 @@ void ChartInDayInfluence()
       SwapN(source[j], source[j+1]);
       SwapN(aspect[j], aspect[j+1]);
       SwapN(dest[j], dest[j+1]);
+      SwapN(orb[j], orb[j+1]);
       SwapR(&power[j], &power[j+1]);
       j--;
     }
@@ -601,7 +601,7 @@ void ChartInDayInfluence()
     PrintAspect(
       j, SFromZ(planet[j]), (int)RSgn(ret[j]), k,
       l, SFromZ(planet[l]), (int)RSgn(ret[l]), 'D');
-    m = grid->v[j][l];
+    m = orb[i];
     AnsiColor(m < 0 ? kWhite : kLtGray);
     sprintf(sz, "- %s%2d%c%02d'", m < 0 ? "app" : "sep",
       abs(m)/60, chDeg1, abs(m)%60); PrintSz(sz);
@@ -136,282 +136,140 @@ int obj1, asp, obj2;
 
 #ifdef LOGAN
 
-int SzLoganZodiac(deg, d, m)
+/* Convert a zodiac position to whole arc seconds from 0 Aries, always */
+/* truncated to the second whatever is being displayed. The Vedic      */
+/* divisions are all found from this with the integer arithmetic in    */
+/* astrolog.h, so they don't depend on output formatting. Rounding for */
+/* display is left to IRasiDms() below.                                */
+
+long LZodiacSec(deg)
 real deg;
-int *d;
-int *m;
 {
-  int sign;
-  real s;
+  return (long)(Mod(deg)*3600.0) % cSecCircle;
+}
 
-  /* format the position in degrees/minutes format: and return sign as integer */
 
-  deg = Mod(deg + (is.fSeconds ? rRound/60.0/60.0 : rRound/60.0));
-  sign = (int)(deg / 30.0);
-  *d = (int)deg - sign*30;
-  *m = (int)(RFract(deg)*60.0);
+/* Return the rasi (0-11) a zodiac position falls in, along with the     */
+/* degree, minute, and second within it for display. These are rounded   */
+/* to the minute (or second, if seconds are being displayed) just as     */
+/* SzZodiac() would print them, but never up into the next rasi, so the  */
+/* rasi always agrees with the divisions found from LZodiacSec().        */
 
-  return sign + 1;
+int IRasiDms(deg, d, m, s)
+real deg;
+int *d, *m, *s;
+{
+  long l, lRound;
+
+  l = LZodiacSec(deg);
+  lRound = LZodiacSec(deg + (is.fSeconds ? rRound/60.0/60.0 : rRound/60.0));
+  if (lRound/cSecSign != l/cSecSign)
+    lRound = l;
+  if (!is.fSeconds)
+    lRound -= lRound % 60L;
+  *d = (int)(lRound/3600L % 30L);
+  *m = (int)(lRound/60L % 60L);
+  *s = (int)(lRound % 60L);
+  return (int)(l/cSecSign);
 }
 
 int getNaksatra(rdeg)
 real rdeg;
 {
-    int actualmin;
-    int rasi;
-    int deg;
-    int min;
-    int i;
-    extern int nakdeg[];
-
-    rasi = SzLoganZodiac(rdeg, &deg, &min);
-
-    actualmin = ((deg * 60) + ((rasi - 1) * 30 * 60)) + min;
-
-    for (i = 0; i < 28; i++) {
-        if ((actualmin >= nakdeg[i])  && (actualmin < nakdeg[i + 1])) {
-            return(i);
-        }
-    }
-
-    return(0);
+    NK nk;
 
+    NakshatraOf(LZodiacSec(rdeg), &nk);
+    return nk.nak;
 }
 
 int getTithi(sdeg, mdeg)
 real sdeg;
 real mdeg;
 {
-    int ti = 1;
-    float ddeg;
-
-    if (sdeg < mdeg) {
-        sdeg += 360.0;
-    }
-
-    ddeg = sdeg - mdeg;
-
-    ddeg = 360 - ddeg;
-
-    ti = (int)(ddeg / 12);
-    ti++;
-
-    /*
-    if (ti >= 15) {
-        ti = ti - 15;
-    }
-    */
-
-    /*
-    printf("sdeg %f mdeg %f ddeg %f ti %d\n",
-            sdeg, mdeg, ddeg, ti);
-            */
-
-    return (ti);
+    return TithiFromSec(LZodiacSec(sdeg), LZodiacSec(mdeg));
 }
 
 int getYogas(sdeg, mdeg)
 real sdeg;
 real mdeg;
 {
-    int smin;
-    int mmin;
-    int rasi;
-    int deg;
-    int min;
-    int i;
-    int summin;
-    extern int nakdeg[];
-
-    rasi = SzLoganZodiac(sdeg, &deg, &min);
-    smin = ((deg * 60) + ((rasi - 1) * 30 * 60)) + min;
-
-    rasi = SzLoganZodiac(mdeg, &deg, &min);
-    mmin = ((deg * 60) + ((rasi - 1) * 30 * 60)) + min;
-
-    summin = smin + mmin;
-
-    if (summin > 21600) {
-        summin -= 21600;
-    }
-
-    for (i = 0; i < 28; i++) {
-        if ((summin >= nakdeg[i])  && (summin < nakdeg[i + 1])) {
-            return(i);
-        }
-    }
-
-    return(0);
+    return YogaFromSec(LZodiacSec(sdeg), LZodiacSec(mdeg));
 }
 
 int getNavamsa(rdeg)
 real rdeg;
 {
-  int actualmin;
-  int padam = 0;
-  int offset = 0;
-  int rasi;
-  int deg;
-  int min;
+    /* Return the house of navamsa */
+    return VargaFromSec(LZodiacSec(rdeg), 9) + 1;
+}
 
-  rasi = SzLoganZodiac(rdeg, &deg, &min);
 
-  actualmin = deg * 60 + min;
+/* Return the sign (0-11) a position in arc seconds falls in within the  */
+/* given divisional chart, e.g. 9 for the navamsa or 10 for the dasamsa, */
+/* or -1 for a division not handled. Each sign is split into that many   */
+/* equal parts, and which part it is gives the sign counted on from a    */
+/* start that depends on the rasi, by the usual Parashari rules. For     */
+/* the navamsa, counting on from Aries, Capricorn, Libra, or Cancer by   */
+/* element comes to the same as 9 parts per sign counted from Aries.     */
 
-  switch(rasi)
-  {
-    case 1:
-      if (actualmin >= 0 && actualmin < 800) { 
-        padam = (actualmin / 200) + 1;
-        offset = 0;
-      } else if (actualmin >= 800 && actualmin < 1600) {
-        padam = ((actualmin - 800) / 200) + 1;
-        offset = 4;
-      } else if (actualmin >= 1600 && actualmin < 1800) {
-        padam = ((actualmin - 1600) / 200) + 1;
-        offset = 8;
-      }
-      break;
-    case 2:
-      if (actualmin >= 0 && actualmin < 600) {
-        padam = (actualmin / 200) + 2;
-        offset = 8;
-      } else if (actualmin >= 600 && actualmin < 1400) {
-        padam = ((actualmin - 600) / 200) + 1;
-        offset = 0;
-      } else if (actualmin >= 1400 && actualmin < 1800) {
-        padam = ((actualmin - 1400) / 200) + 1;
-        offset = 4;
-      }
-      break;
-    case 3:
-      if (actualmin >= 0 && actualmin < 400) { 
-        padam = (actualmin / 200) + 3;
-        offset = 4;
-      } else if (actualmin >= 400 && actualmin < 1200) {
-        padam = ((actualmin - 400) / 200) + 1;
-        offset = 8;
-      } else if (actualmin >= 1200 && actualmin < 1800) {
-        padam = ((actualmin - 1200) / 200) + 1;
-        offset = 0;
-      }
-      break;
-    case 4:
-      if (actualmin >= 0 && actualmin < 200) { 
-        padam = (actualmin / 200) + 4;
-        offset = 0;
-      } else if (actualmin >= 200 && actualmin < 1000) {
-        padam = ((actualmin - 200) / 200) + 1;
-        offset = 4;
-      } else if (actualmin >= 1000 && actualmin < 1800) {
-        padam = ((actualmin - 1000) / 200) + 1;
-        offset = 8;
-      }
-      break;
-    case 5:
-      if (actualmin >= 0 && actualmin < 800) { 
-        padam = (actualmin / 200) + 1;
-        offset = 0;
-      } else if (actualmin >= 800 && actualmin < 1600) {
-        padam = ((actualmin - 800) / 200) + 1;
-        offset = 4;
-      }
-      else if (actualmin >= 1600 && actualmin < 1800) {
-        padam = ((actualmin - 1600) / 200) + 1;
-        offset = 8;
-      }
-      break;
-    case 6:
-      if (actualmin >= 0 && actualmin < 600) {
-        padam = (actualmin / 200) + 2;
-        offset = 8;
-      } else if (actualmin >= 600 && actualmin < 1400) {
-        padam = ((actualmin - 600) / 200) + 1;
-        offset = 0;
-      } else if (actualmin >= 1400 && actualmin < 1800) {
-        padam = ((actualmin - 1400) / 200) + 1;
-        offset = 4;
-      }
-      break;
-    case 7:
-      if (actualmin >= 0 && actualmin < 400) { 
-        padam = (actualmin / 200) + 3;
-        offset = 4;
-      } else if (actualmin >= 400 && actualmin < 1200) {
-        padam = ((actualmin - 400) / 200) + 1;
-        offset = 8;
-      } else if (actualmin >= 1200 && actualmin < 1800) {
-        padam = ((actualmin - 1200) / 200) + 1;
-        offset = 0;
-      }
-      break;
-    case 8:
-      if (actualmin >= 0 && actualmin < 200) { 
-        padam = (actualmin / 200) + 4;
-        offset = 0;
-      } else if (actualmin >= 200 && actualmin < 1000) {
-        padam = ((actualmin - 200) / 200) + 1;
-        offset = 4;
-      } else if (actualmin >= 1000 && actualmin < 1800) {
-        padam = ((actualmin - 1000) / 200) + 1;
-        offset = 8;
-      }
-      break;
-    case 9:
-      if (actualmin >= 0 && actualmin < 800) { 
-        padam = (actualmin / 200) + 1;
-        offset = 0;
-      } else if (actualmin >= 800 && actualmin < 1600) {
-        padam = ((actualmin - 800) / 200) + 1;
-        offset = 4;
-      } else if (actualmin >= 1600 && actualmin < 1800) {
-        padam = ((actualmin - 1600) / 200) + 1;
-        offset = 8;
-      }
-      break;
-    case 10:
-      if (actualmin >= 0 && actualmin < 600) {
-        padam = (actualmin / 200) + 2;
-        offset = 8;
-      } else if (actualmin >= 600 && actualmin < 1400) {
-        padam = ((actualmin - 600) / 200) + 1;
-        offset = 0;
-      } else if (actualmin >= 1400 && actualmin < 1800) {
-        padam = ((actualmin - 1400) / 200) + 1;
-        offset = 4;
-      }
-      break;
-    case 11:
-      if (actualmin >= 0 && actualmin < 400) { 
-        padam = (actualmin / 200) + 3;
-        offset = 4;
-      } else if (actualmin >= 400 && actualmin < 1200) {
-        padam = ((actualmin - 400) / 200) + 1;
-        offset = 8;
-      } else if (actualmin >= 1200 && actualmin < 1800) {
-        padam = ((actualmin - 1200) / 200) + 1;
-        offset = 0;
-      }
-      break;
-    case 12:
-      if (actualmin >= 0 && actualmin < 200) { 
-        padam = (actualmin / 200) + 4;
-        offset = 0;
-      } else if (actualmin >= 200 && actualmin < 1000) {
-        padam = ((actualmin - 200) / 200) + 1;
-        offset = 4;
-      } else if (actualmin >= 1000 && actualmin < 1800) {
-        padam = ((actualmin - 1000) / 200) + 1;
-        offset = 8;
-      }
-      break;
-    default:
-      printf("Error\n");
-      break;
+int VargaFromSec(l, n)
+long l;
+int n;
+{
+  int rasi, k;
+  _bool fOdd;
+
+  rasi = (int)(l / cSecSign);
+  k = (int)(l % cSecSign * n / cSecSign);
+  fOdd = (rasi & 1) == 0;
+  switch (n) {
+  case 1:  return rasi;
+  case 2:  return fOdd == (k == 0) ? 4 : 3;    /* Hora: Leo or Cancer.  */
+  case 3:  return (rasi + 4*k) % cSign;        /* Drekkana: 1, 5, 9th.  */
+  case 4:  return (rasi + 3*k) % cSign;
+  case 7:  return (rasi + (fOdd ? 0 : 6) + k) % cSign;
+  case 9:  return (rasi*9 + k) % cSign;        /* Navamsa.              */
+  case 10: return (rasi + (fOdd ? 0 : 8) + k) % cSign;
+  case 12: return (rasi + k) % cSign;
+  case 16: return (rasi % 3 * 4 + k) % cSign;  /* Aries, Leo, or Sag.   */
+  case 60: return (rasi + k) % cSign;
   }
+  return -1;
+}
+
+
+/* Compute many divisional signs at once, for every longitude in arc      */
+/* seconds given, such as all the grahas of a batch of charts, in each of */
+/* the divisions given. The sign of longitude i in division j goes into   */
+/* rgb[i*cn + j], or 255 if that division isn't handled. Each division's  */
+/* signs are laid out first by rasi and part, so the loop over the        */
+/* longitudes is just index arithmetic and a table lookup for each one.   */
 
-  // Return the house of navamsa
-  return(padam + offset);
+void VargaBatch(rgl, cl, rgn, cn, rgb)
+CONST long *rgl;
+int cl;
+CONST int *rgn;
+int cn;
+byte *rgb;
+{
+  byte rgbT[cSign*60];
+  long l, n;
+  int i, j, k;
+
+  for (j = 0; j < cn; j++) {
+    n = rgn[j];
+    if (n < 1 || n > 60 || VargaFromSec(0L, (int)n) < 0) {
+      for (i = 0; i < cl; i++)
+        rgb[(long)i*cn + j] = 255;
+      continue;
+    }
+    for (k = 0; k < cSign*n; k++)
+      rgbT[k] = (byte)VargaFromSec((cSecSign*k + cSecSign/2) / n, (int)n);
+    for (i = 0; i < cl; i++) {
+      l = rgl[i];
+      rgb[(long)i*cn + j] = rgbT[l/cSecSign*n + l%cSecSign*n/cSecSign];
+    }
+  }
 }
 
 extern int navasp;
@@ -420,6 +278,7 @@ extern int autodst;
 extern int tithi;
 extern int yoga;
 extern int sunraise;
+extern real rSunAlt;
 extern int predictor;
 extern int yoga;
 
@@ -605,6 +464,169 @@ findDst(int curmon, int curday, int curyear, int curtime)
 ******************************************************************************
 */
 
+/* Given the angle from one object to another at the start of a search    */
+/* segment, and the most that angle can change over the segment, return   */
+/* whether it can reach any aspect angle during it. Since the -d search's */
+/* test looks for a change of sign in the angle minus the aspect, either  */
+/* the aspect or its opposite point can trigger it, so 'rgrAsp' contains  */
+/* the aspect angles folded into 0..180 and sorted. We binary search for  */
+/* the gap between aspects the angle falls into, and only need to check   */
+/* the distance to the two aspects at either end of that gap.             */
+
+bool FAspectInReach(rAngle, rMove, rgrAsp, cAsp)
+real rAngle, rMove, *rgrAsp;
+int cAsp;
+{
+  int iLo, iHi, i;
+  real r;
+
+  if (cAsp <= 0)
+    return fFalse;
+  if (rMove >= rDegQuad)
+    return fTrue;
+  rAngle = Mod(rAngle);
+  if (rAngle >= rDegHalf)
+    rAngle -= rDegHalf;
+  iLo = 0; iHi = cAsp;
+  while (iLo < iHi) {
+    i = (iLo + iHi) >> 1;
+    if (rgrAsp[i] < rAngle)
+      iLo = i+1;
+    else
+      iHi = i;
+  }
+  r = RAbs(rAngle - rgrAsp[iLo < cAsp ? iLo : 0]);
+  if (Min(r, rDegHalf - r) <= rMove)
+    return fTrue;
+  r = RAbs(rAngle - rgrAsp[iLo > 0 ? iLo-1 : cAsp-1]);
+  return Min(r, rDegHalf - r) <= rMove;
+}
+
+
+/* Cast the chart for a time during the day being searched by the -d    */
+/* switch, making it the end point of the current segment. The previous */
+/* end point's positions are moved to become the segment's start point. */
+
+void CastInDaySegment(pcs, mon, yea, tim, fProg)
+CS *pcs;
+int mon, yea;
+real tim;
+bool fProg;
+{
+  int i;
+
+#ifdef LOGAN
+  if (autodst) {
+    Dst = findDst(mon, Day2, yea, (int)tim);
+  }
+#endif /* LOGAN */
+
+  SetCI(ciCore, mon, Day2, yea, tim, Dst, Zon, Lon, Lat);
+  if (fProg) {
+    is.JDp = MdytszToJulian(Mon2, DD+1, yea, 0.0, Dst, Zon);
+    ciCore = ciMain;
+  }
+  CastChartStep(pcs, cmSearch);
+  for (i = 1; i <= cSign; i++) {
+    cp1.cusp[i] = cp2.cusp[i]; cp1.house[i] = cp2.house[i];
+    cp2.cusp[i] = house[i];  cp2.house[i] = inhouse[i];
+  }
+  /* Get Ketu's position hard coded -Logan */
+  planet[17] = Mod(planet[16] + 180);
+  ret[17] = ret[16];
+  for (i = 1; i <= cObj; i++) {
+    cp1.obj[i] = cp2.obj[i]; cp1.dir[i] = cp2.dir[i];
+    cp2.obj[i] = planet[i];  cp2.dir[i] = ret[i];
+#ifdef LOGAN
+    cp1.navamsa[i] = cp2.navamsa[i];
+    if (naksatra) {
+      if (i != oMoo) {
+          continue;
+      }
+      cp2.navamsa[i] = getNaksatra(planet[i]);
+    } else if (tithi) {
+        if (i != oMoo) {
+            continue;
+        }
+        cp2.navamsa[i] = getTithi(planet[oSun], planet[oMoo]);
+    } else if (yoga) {
+        if (i != oMoo) {
+            continue;
+        }
+        cp2.navamsa[i] = getYogas(planet[oSun], planet[oMoo]);
+    } else if (navasp) {
+        cp2.navamsa[i] = getNavamsa(planet[i]);
+    }
+#endif /* LOGAN */
+  }
+}
+
+
+/* Given a list of market sessions, return the first one that's trading  */
+/* at the given minute of the day, or -1 if none are. The minute is on   */
+/* the clock of a chart in time zone zon, and is moved to each session's */
+/* own zone before being checked, since session times are given in the   */
+/* exchange's local time. That may put it on the day before or after, so */
+/* it's wrapped back into the day, and a session closing at an earlier   */
+/* time than it opens is taken to run over midnight. Both ends of a      */
+/* session are inclusive. Daylight time is assumed to be the same at the */
+/* exchange as in the chart.                                             */
+
+int ImsInSession(rgims, cims, zon, lt)
+int *rgims, cims;
+real zon;
+int lt;
+{
+  int i, l, lOpen, lClose;
+  MS *pms;
+
+  for (i = 0; i < cims; i++) {
+    pms = &rgms[rgims[i]];
+    l = lt + NMinTim(zon) - NMinTim(pms->zon);
+    l = (l % 1440 + 1440) % 1440;
+    lOpen = NMinTim(pms->open); lClose = NMinTim(pms->close);
+    if (lOpen <= lClose ? l >= lOpen && l <= lClose :
+      l >= lOpen || l <= lClose)
+      return rgims[i];
+  }
+  return -1;
+}
+
+
+/* Return whether any events found in a segment of a day, lasting between */
+/* the given minutes of the day on the chart's clock, could fall during   */
+/* one of the sessions. Events are displayed based on their time          */
+/* truncated to the minute, so the segment is widened a bit to not lose   */
+/* any right at either end. Once moved to a session's own zone, the       */
+/* segment is wrapped to start within the day, and compared against the   */
+/* session on that day and the days either side, which covers segments    */
+/* and sessions running over midnight as in ImsInSession() above.         */
+
+bool FInSession(rgims, cims, zon, rStart, rEnd)
+int *rgims, cims;
+real zon, rStart, rEnd;
+{
+  int i, k;
+  real r1, r2, rOpen, rClose;
+  MS *pms;
+
+  for (i = 0; i < cims; i++) {
+    pms = &rgms[rgims[i]];
+    r1 = rStart + (real)(NMinTim(zon) - NMinTim(pms->zon)) - 1.0;
+    r1 -= RFloor(r1/1440.0)*1440.0;
+    r2 = r1 + (rEnd - rStart) + 2.0;
+    rOpen = (real)NMinTim(pms->open);
+    rClose = (real)NMinTim(pms->close) + 1.0;
+    if (rClose <= rOpen)
+      rClose += 1440.0;
+    for (k = -1; k <= 1; k++)
+      if (r2 >= rOpen + (real)k*1440.0 && r1 <= rClose + (real)k*1440.0)
+        return fTrue;
+  }
+  return fFalse;
+}
+
+
 /* Search through a day, and print out the times of exact aspects among the  */
 /* planets during that day, as specified with the -d switch, as well as the  */
 /* times when a planet changes sign or direction. To do this, we cast charts */
@@ -617,20 +639,66 @@ bool fProg;
 {
   char sz[cchSzDef];
   char tch[10];
-  int source[MAXINDAY], aspect[MAXINDAY], dest[MAXINDAY],
-    sign1[MAXINDAY], sign2[MAXINDAY];
-  int D1, D2, occurcount, division, div,
-    fYear, yea0, yea1, yea2, i, j, k, l, s1, s2;
-  real time[MAXINDAY], divsiz, d1, d2, e1, e2, f1, f2, g;
+  EL el;
+  EI FPTR *pei;
+  int D1, D2, division, div, fYear, yea0, yea1, yea2, i, j, k, l, s1, s2,
+    mon, day, yea, cAsp, rgims[MAXSESSION], cims, ims, fPrune, fGap, fHome, fSunRise, fScan;
+  real divsiz, d1, d2, e1, e2, f1, f2, g, rMove[objMax], rgrAsp[cAspect+1];
   extern real lret[objMax];
   CI ciT;
+  CS cs;
 
   /* If parameter 'fProg' is set, look for changes in a progressed chart. */
 
   ciT = ciTwin;
+  el.rgei = NULL; el.cei = el.ceiMax = 0;
+
+  /* Fold the aspect angles into half a circle and sort them, so each pair */
+  /* of objects can be quickly checked against the gaps between aspects.   */
+
+  cAsp = 0;
+  for (k = 1; k <= us.nAsp; k++) {
+    g = Mod(rAspAngle[k]);
+    if (g >= rDegHalf)
+      g -= rDegHalf;
+    for (i = cAsp; i > 0 && rgrAsp[i-1] > g; i--)
+      rgrAsp[i] = rgrAsp[i-1];
+    rgrAsp[i] = g;
+    cAsp++;
+  }
+
+  /* Determine which market sessions, if any, trade at the chart location. */
+  /* With -Yt on, only events during those sessions get displayed, and if  */
+  /* each of them limits all its events to session hours, segments of the  */
+  /* day wholly outside every session don't need to be searched at all.    */
+
+  cims = 0; fHome = fFalse;
+  for (i = 0; i < cms; i++)
+    if (rgms[i].lon == Lon && rgms[i].lat == Lat) {
+      rgims[cims++] = i;
+      fHome |= rgms[i].fLagna;
+    }
+  fPrune = us.fEuroTime && !tithi && cims > 0 && !fHome;
+
+#ifdef LOGAN
+  /* With -= the Sun's rising and setting are solved for directly, so the  */
+  /* day only needs to be scanned if other objects can cross the Ascendant */
+  /* or the Sun can make aspects to it other than the conjunction and      */
+  /* opposition. Events not involving the Ascendant aren't displayed.      */
+
+  fSunRise = sunraise && !fProg;
+  fScan = !fSunRise;
+  if (fSunRise && !ignore[oAsc])
+    for (i = 1; i <= cObj && !fScan; i++)
+      fScan = !ignore[i] && i != oAsc && (i != oSun || us.nAsp > aOpp);
+#else
+  fSunRise = fFalse; fScan = fTrue;
+#endif
+
   fYear = us.fInDayMonth && (Mon2 == 0);
   division = (fYear || fProg) ? 1 : us.nDivision;
   divsiz = 24.0 / (real)division*60.0;
+  BeginChartStep(&cs, Lon, Lat);
 
   /* If -dY in effect, then search through a range of years. */
 
@@ -652,7 +720,7 @@ bool fProg;
   /* Start searching the day or days in question for exciting stuff. */
 
   for (Day2 = D1; Day2 <= D2; Day2 = AddDay(Mon, Day2, yea0, 1)) {
-    occurcount = 0;
+    el.cei = 0;
 
 #ifdef LOGAN
     if (autodst) {
@@ -667,7 +735,7 @@ bool fProg;
       is.JDp = MdytszToJulian(Mon2, DD, yea0, 0.0, Dst, Zon);
       ciCore = ciMain;
     }
-    CastChart(fTrue);
+    CastChartStep(&cs, cmSearch);
     for (i = 1; i <= cSign; i++) {
       cp2.cusp[i] = house[i];
       cp2.house[i] = inhouse[i];
@@ -705,56 +773,34 @@ bool fProg;
     /* Now divide the day into segments and search each segment in turn. */
     /* More segments is slower, but has slightly better time accuracy.   */
 
-    for (div = 1; div <= division; div++) {
-        real curTime = DegToDec(24.0*(real)div/(real)division);
+    fGap = fFalse;
+    for (div = 1; fScan && div <= division; div++) {
+
+      /* Skip segments that can't contain any events we'll display. If we */
+      /* skipped the previous segment, we need to recast its end point.   */
+
+      if (fPrune && !FInSession(rgims, cims, Zon,
+        (real)(div-1)*divsiz, (real)div*divsiz)) {
+        fGap = fTrue;
+        continue;
+      }
+      if (fGap) {
+        CastInDaySegment(&cs, fYear ? Mon2 : Mon, yea0,
+          DegToDec(24.0*(real)(div-1)/(real)division), fProg);
+        fGap = fFalse;
+      }
 
       /* Cast the chart for the ending time of the present segment. The   */
       /* beginning time chart is copied from the previous end time chart. */
 
-#ifdef LOGAN
-      if (autodst) {
-        Dst = findDst(fYear ? Mon2 : Mon, Day2, yea0, (int)curTime);
-      }
-#endif /* LOGAN */
+      CastInDaySegment(&cs, fYear ? Mon2 : Mon, yea0,
+        DegToDec(24.0*(real)div/(real)division), fProg);
 
-      SetCI(ciCore, fYear ? Mon2 : Mon, Day2, yea0, curTime, Dst, Zon, Lon, Lat);
-      if (fProg) {
-        is.JDp = MdytszToJulian(Mon2, DD+1, yea0, 0.0, Dst, Zon);
-        ciCore = ciMain;
-      }
-      CastChart(fTrue);
-      for (i = 1; i <= cSign; i++) {
-        cp1.cusp[i] = cp2.cusp[i]; cp1.house[i] = cp2.house[i];
-        cp2.cusp[i] = house[i];  cp2.house[i] = inhouse[i];
-      }
-      /* Get Ketu's position hard coded -Logan */
-      planet[17] = Mod(planet[16] + 180);
-      ret[17] = ret[16];
-      for (i = 1; i <= cObj; i++) {
-        cp1.obj[i] = cp2.obj[i]; cp1.dir[i] = cp2.dir[i];
-        cp2.obj[i] = planet[i];  cp2.dir[i] = ret[i];
-#ifdef LOGAN
-        cp1.navamsa[i] = cp2.navamsa[i];
-        if (naksatra) {
-          if (i != oMoo) {
-              continue;
-          }
-          cp2.navamsa[i] = getNaksatra(planet[i]);
-        } else if (tithi) {
-            if (i != oMoo) {
-                continue;
-            }
-            cp2.navamsa[i] = getTithi(planet[oSun], planet[oMoo]);
-        } else if (yoga) {
-            if (i != oMoo) {
-                continue;
-            }
-            cp2.navamsa[i] = getYogas(planet[oSun], planet[oMoo]);
-        } else if (navasp) {
-            cp2.navamsa[i] = getNavamsa(planet[i]);
-        }
-#endif /* LOGAN */
-      }
+      /* Note how far each object moves during the segment. The angle   */
+      /* between two objects can't change by more than the sum of them. */
+
+      for (i = 1; i <= cObj; i++)
+        rMove[i] = MinDistance(cp1.obj[i], cp2.obj[i]) + rSmall;
 
       /* Now search through the present segment for anything exciting. */
 
@@ -766,42 +812,30 @@ bool fProg;
     // Check for the sign change in Navamsa
         if (navasp && !ignore[i] && cp1.navamsa[i] != cp2.navamsa[i] && 
             !ignore[0]) {
-          source[occurcount] = i;
-          aspect[occurcount] = -11; // Indicate that it is Navamsa
-          dest[occurcount] = cp2.navamsa[i];
-          time[occurcount] = (24.0*(real)div/(real)division) * 60.0;
-          sign1[occurcount] = sign2[occurcount] = cp1.navamsa[i];
-          occurcount++;
+          PAddEvent(&el, (24.0*(real)div/(real)division) * 60.0,
+            i, -11, cp2.navamsa[i], // Indicate that it is Navamsa
+            cp1.navamsa[i], cp1.navamsa[i]);
         }
 
         if (naksatra && !ignore[i] && cp1.navamsa[i] != cp2.navamsa[i] && 
             !ignore[0]) {
-          source[occurcount] = i;
-          aspect[occurcount] = -13; // Indicate that it is Nakshatra
-          dest[occurcount] = cp2.navamsa[i];
-          time[occurcount] = (24.0*(real)div/(real)division) * 60.0;
-          sign1[occurcount] = sign2[occurcount] = cp1.navamsa[i];
-          occurcount++;
+          PAddEvent(&el, (24.0*(real)div/(real)division) * 60.0,
+            i, -13, cp2.navamsa[i], // Indicate that it is Nakshatra
+            cp1.navamsa[i], cp1.navamsa[i]);
         }
 
         if (tithi && !ignore[i] && cp1.navamsa[i] != cp2.navamsa[i] && 
             !ignore[0]) {
-          source[occurcount] = i;
-          aspect[occurcount] = -15; // Indicate Tithi change
-          dest[occurcount] = cp2.navamsa[i];
-          time[occurcount] = (24.0*(real)div/(real)division) * 60.0;
-          sign1[occurcount] = sign2[occurcount] = cp1.navamsa[i];
-          occurcount++;
+          PAddEvent(&el, (24.0*(real)div/(real)division) * 60.0,
+            i, -15, cp2.navamsa[i], // Indicate Tithi change
+            cp1.navamsa[i], cp1.navamsa[i]);
         }
 
         if (yoga && !ignore[i] && cp1.navamsa[i] != cp2.navamsa[i] && 
             !ignore[0]) {
-          source[occurcount] = i;
-          aspect[occurcount] = -17; // Indicate yoga change
-          dest[occurcount] = cp2.navamsa[i];
-          time[occurcount] = (24.0*(real)div/(real)division) * 60.0;
-          sign1[occurcount] = sign2[occurcount] = cp1.navamsa[i];
-          occurcount++;
+          PAddEvent(&el, (24.0*(real)div/(real)division) * 60.0,
+            i, -17, cp2.navamsa[i], // Indicate yoga change
+            cp1.navamsa[i], cp1.navamsa[i]);
         }
 
 #endif /* LOGAN */
@@ -809,40 +843,28 @@ bool fProg;
         /* Does the current planet change into the next or previous sign? */
 
         if (naksatra == 0 && !ignore[i] && s1 != s2 && !ignore[0]) {
-          source[occurcount] = i;
-          aspect[occurcount] = aSig;
-          dest[occurcount] = s2+1;
-          time[occurcount] = MinDistance(cp1.obj[i],
+          PAddEvent(&el, MinDistance(cp1.obj[i],
             (real)(cp1.dir[i] >= 0.0 ? s2 : s1) * 30.0) /
-            MinDistance(cp1.obj[i], cp2.obj[i])*divsiz + (real)(div-1)*divsiz;
-          sign1[occurcount] = sign2[occurcount] = s1+1;
-          occurcount++;
+            MinDistance(cp1.obj[i], cp2.obj[i])*divsiz + (real)(div-1)*divsiz,
+            i, aSig, s2+1, s1+1, s1+1);
         }
 
         /* Does the current planet go retrograde or direct? */
 
         if (!ignore[i] && (cp1.dir[i] < 0.0) != (cp2.dir[i] < 0.0) &&
           !ignore2[0]) {
-          source[occurcount] = i;
-          aspect[occurcount] = aDir;
-          dest[occurcount] = cp2.dir[i] < 0.0;
-          time[occurcount] = RAbs(cp1.dir[i])/(RAbs(cp1.dir[i])+
-            RAbs(cp2.dir[i]))*divsiz + (real)(div-1)*divsiz;
-          sign1[occurcount] = sign2[occurcount] = s1+1;
-          occurcount++;
+          PAddEvent(&el, RAbs(cp1.dir[i])/(RAbs(cp1.dir[i])+
+            RAbs(cp2.dir[i]))*divsiz + (real)(div-1)*divsiz,
+            i, aDir, cp2.dir[i] < 0.0, s1+1, s1+1);
         }
 
         /* Does the current planet go progression or direct? */
 
         if ((i != oAsc) && ((DFromR(fabs(cp1.dir[i])) / lret[i]) >= 2.0) != 
             ((DFromR(fabs(cp2.dir[i])) / lret[i]) >= 2.0)) {
-          source[occurcount] = i;
-          aspect[occurcount] = -9;
-          dest[occurcount] = (DFromR(fabs(cp2.dir[i])) / lret[i]) >= 2.0;
-          time[occurcount] = RAbs(cp1.dir[i])/(RAbs(cp1.dir[i])+
-            RAbs(cp2.dir[i]))*divsiz + (real)(div-1)*divsiz;
-          sign1[occurcount] = sign2[occurcount] = s1+1;
-          occurcount++;
+          PAddEvent(&el, RAbs(cp1.dir[i])/(RAbs(cp1.dir[i])+
+            RAbs(cp2.dir[i]))*divsiz + (real)(div-1)*divsiz,
+            i, -9, (DFromR(fabs(cp2.dir[i])) / lret[i]) >= 2.0, s1+1, s1+1);
         }
 
         if (tithi) {
@@ -850,9 +872,26 @@ bool fProg;
         }
 
         /* Now search for anything making an aspect to the current planet. */
+        /* Pairs whose angle is too far from every aspect for their motion */
+        /* during the segment to close the gap are skipped, as is each     */
+        /* aspect too far from the angle on its own, as neither could pass */
+        /* the sign change test below.                                     */
 
-        for (j = /*i+*/1; j <= cObj; j++) if (!ignore[j] && (fProg || FThing(j)))
+        for (j = /*i+*/1; j <= cObj; j++) if (!ignore[j] && (fProg || FThing(j))
+#ifdef LOGAN
+          && FAspectInReach(cp1.obj[j]-cp1.obj[i], rMove[i]+rMove[j],
+          rgrAsp, cAsp)
+#endif
+          )
           for (k = 1; k <= us.nAsp; k++) {
+#ifdef LOGAN
+            if (fSunRise && i == oSun && j == oAsc && k <= aOpp)
+              continue;
+            g = RAbs(MinDifference(rAspAngle[k],
+              MinDifference(cp1.obj[i], cp1.obj[j])));
+            if (g > rMove[i]+rMove[j] && g < rDegHalf-(rMove[i]+rMove[j]))
+              continue;
+#endif
 
             if (Aspect(i, k, j)) {
               d1 = cp1.obj[i]; d2 = cp2.obj[i];
@@ -895,10 +934,6 @@ bool fProg;
                 f2 -= RSgn(f2)*rDegMax;
               if (MinDistance(Midpoint(d1, d2), Midpoint(e1, e2)) < rDegQuad &&
                 RSgn(f1) != RSgn(f2)) {
-                source[occurcount] = i;
-                aspect[occurcount] = k;
-                dest[occurcount] = j;
-
                 /* Horray! The aspect occurs sometime during the interval.   */
                 /* Now we just have to solve an equation in two variables to */
                 /* find out where the "lines" cross, i.e. the aspect's time. */
@@ -911,47 +946,46 @@ bool fProg;
                   f2 -= RSgn(f2)*rDegMax;
                 g = (RAbs(d1-e1) > rDegHalf ?
                   (d1-e1)-RSgn(d1-e1)*rDegMax : d1-e1)/(f2-f1);
-                time[occurcount] = g*divsiz + (real)(div-1)*divsiz;
-                sign1[occurcount] = (int)(Mod(cp1.obj[i]+
+                PAddEvent(&el, g*divsiz + (real)(div-1)*divsiz, i, k, j,
+                  (int)(Mod(cp1.obj[i]+
                   RSgn(cp2.obj[i]-cp1.obj[i])*
                   (RAbs(cp2.obj[i]-cp1.obj[i]) > rDegHalf ? -1 : 1)*
-                  RAbs(g)*MinDistance(cp1.obj[i], cp2.obj[i]))/30.0)+1;
-                sign2[occurcount] = (int)(Mod(cp1.obj[j]+
+                  RAbs(g)*MinDistance(cp1.obj[i], cp2.obj[i]))/30.0)+1,
+                  (int)(Mod(cp1.obj[j]+
                   RSgn(cp2.obj[j]-cp1.obj[j])*
                   (RAbs(cp2.obj[j]-cp1.obj[j]) > rDegHalf ? -1 : 1)*
-                  RAbs(g)*MinDistance(cp1.obj[j], cp2.obj[j]))/30.0)+1;
-                occurcount++;
+                  RAbs(g)*MinDistance(cp1.obj[j], cp2.obj[j]))/30.0)+1);
               }
             }
           }
       }
     }
 
+#ifdef LOGAN
+    /* With -= add the Sun's rising and setting, found from its hour angle. */
+
+    if (fSunRise && !ignore[oSun]) {
+      if (autodst)
+        Dst = findDst(fYear ? Mon2 : Mon, Day2, yea0, 0);
+      AddSunRiseEvents(&el, fYear ? Mon2 : Mon, Day2, yea0);
+    }
+#endif
+
     /* After all the aspects, etc, in the day have been located, sort   */
     /* them by time at which they occur, so we can print them in order. */
+    /* Each day's events all fall within that day, so printing the days */
+    /* one after another keeps the whole range in chronological order.  */
 
-    /*
-     * Astrosee Web site has a bug with the swap routine -Logan
-    for (i = 1; i < occurcount; i++) {
-      j = i-1;
-      while (j >= 0 && time[j] > time[j+1]) {
-        SwapN(source[j], source[j+1]);
-        SwapN(aspect[j], aspect[j+1]);
-        SwapN(dest[j], dest[j+1]);
-        SwapR(&time[j], &time[j+1]);
-        SwapN(sign1[j], sign1[j+1]); SwapN(sign2[j], sign2[j+1]);
-        j--;
-      }
-    }
-    */
+    SortEvents(&el);
 
     /* Finally, loop through and display each aspect and when it occurs. */
 
-    for (i = 0; i < occurcount; i++) {
+    for (i = 0; i < el.cei; i++) {
+      pei = &el.rgei[i];
       int lt;
       int printFlag = 0;
-      s1 = (int)time[i]/60;
-      s2 = (int)time[i]-s1*60;
+      s1 = (int)pei->time/60;
+      s2 = (int)pei->time-s1*60;
       lt = ((s1 * 60) + s2);
       j = Day2;
       if (fYear || fProg) {
@@ -965,111 +999,104 @@ bool fProg;
 
       // If -4 argument is passed then print only
       // Navamsa changes
-      if (navasp && (aspect[i] != -11)) {
+      if (navasp && (pei->aspect != -11)) {
           continue;
       }
 
       // If -% argument is passed then print only
       // Yoga changes
-      if (yoga && (aspect[i] != -17)) {
+      if (yoga && (pei->aspect != -17)) {
           continue;
       }
 
-#define SIX30    ((6 * 60) + 30)
-#define ONEPM    (13 * 60)
-#define EIGHT30    ((8 * 60) + 30)
-#define THREEPM    (15 * 60)
-#define NINE30    ((9 * 60) + 30)
-#define FOURPM    (16 * 60)
       sprintf(tch, "(%c)", ciMain.loc[0]); 
       printFlag = 0;
 
       // If -8 argument is pased then print only
       // Full Moon/New Moon aspects
       if (tithi) {
-          if ((aspect[i] == aCon) || (aspect[i] == aOpp) ||
-                  (aspect[i] == -15)) {
+          if ((pei->aspect == aCon) || (pei->aspect == aOpp) ||
+                  (pei->aspect == -15)) {
               printFlag = 1;
           } else {
               continue;
           }
       }
 
-      if (us.fEuroTime == 0) {  /* if Yt is not set print everything */
+      // With -Yt only print events during the trading
+      // session of an exchange at the chart location.
+      // Times are then shown moved from the chart's
+      // time zone to the default time zone, which can
+      // put them on the day before or after.
+      ims = cims > 0 ? ImsInSession(rgims, cims, Zon, lt) : -1;
+      if (us.fEuroTime == 0 || cims == 0 || ims >= 0) {
         printFlag = 1;
       }
-      else 
-      if ((Lon == 122.00) && (Lat == 37.23)) { /* Sunnyvale */
-        if ((lt >= SIX30) && (lt <= ONEPM)) {
-          printFlag = 1;
-        }
-      }
-      else
-      if ((Lon == 87.39) && (Lat == 41.51)) { /* Chicago */
-        if ((lt >= EIGHT30) && (lt <= THREEPM)) {
-          printFlag = 1;
-        }
-      }
-      else 
-      if ((Lon == 74.00) && (Lat == 40.42)) { /* New York */
-        if ((lt >= NINE30) && (lt <= FOURPM)) {
-          printFlag = 1;
-        }
-      }
-      else {
-        printFlag = 1;
+
+      mon = Mon; day = Day2; yea = Yea;
+      if (cims > 0) {
+        l = lt + NMinTim(Zon) - NMinTim(us.zonDef);
+        k = (int)Dvd((long)l, 1440L);
+        l -= k*1440;
+        s1 = l/60;
+        s2 = l%60;
+        if (k != 0)
+          JulianToMdy((real)(MdyToJulian(mon, day, yea) + k), &mon, &day,
+            &yea);
       }
 
-      if ((Lon == 74.00) && (Lat == 40.42)) { /* New York */
-          s1 = s1 - 3;
-      } else if ((Lon == 87.39) && (Lat == 41.51)) { /* Chicago */
-          s1 = s1 - 2;
+      /* With -~ give the event to the output sink at its time in UT. */
+
+      if (printFlag && FSink()) {
+        SinkEvent(MdytszToJulian(fYear ? Mon2 : Mon, Day2, yea0, 0.0, Dst,
+          Zon) - rRound + pei->time/(24.0*60.0), pei);
+        continue;
       }
 
       if (printFlag) {
-        int dayofweek = DayOfWeek(Mon, Day2, Yea);
+        int dayofweek = DayOfWeek(mon, day, yea);
 
         if (naksatra || tithi || yoga || sunraise) {
           if (sunraise) {
-              if (dest[i] == 21) {
-                sprintf(sz, "%c%c%c %2d/%2d/%2d ", chDay3(dayofweek), Mon, Day2, Yea); PrintSz(sz);
+              if (pei->dest == 21) {
+                sprintf(sz, "%c%c%c %2d/%2d/%2d ", chDay3(dayofweek), mon, day, yea); PrintSz(sz);
               }
           } else {
-              sprintf(sz, "%c%c%c %2d/%2d/%2d ", chDay3(dayofweek), Mon, Day2, Yea); PrintSz(sz);
+              sprintf(sz, "%c%c%c %2d/%2d/%2d ", chDay3(dayofweek), mon, day, yea); PrintSz(sz);
           }
         } else {
           if ((predictor) || us.fInDayMonth) {
-            sprintf(sz, "%c%c%c %2d/%2d/%2d ", chDay3(dayofweek), Mon, Day2, Yea); PrintSz(sz);
+            sprintf(sz, "%c%c%c %2d/%2d/%2d ", chDay3(dayofweek), mon, day, yea); PrintSz(sz);
           }
           sprintf(sz, "%2d:%02d %s ", s1, s2, tch); PrintSz(sz);
         }
-        PrintAspect(source[i], sign1[i],
-          (int)RSgn(cp1.dir[source[i]])+(int)RSgn(cp2.dir[source[i]]),
-          aspect[i], dest[i], sign2[i],
-          (int)RSgn(cp1.dir[dest[i]])+(int)RSgn(cp2.dir[dest[i]]),
+        PrintAspect(pei->source, pei->sign1,
+          (int)RSgn(cp1.dir[pei->source])+(int)RSgn(cp2.dir[pei->source]),
+          pei->aspect, pei->dest, pei->sign2,
+          (int)RSgn(cp1.dir[pei->dest])+(int)RSgn(cp2.dir[pei->dest]),
           (char)(fProg ? 'e' : 'd'));
         if (naksatra || tithi || yoga || sunraise) {
           if (sunraise) {
-              if (dest[i] == 21) {
+              if (pei->dest == 21) {
                 sprintf(sz, "%2d:%02d %s\n", s1 > 12 ? s1 - 12 : s1, s2, s1 >= 12 ? "PM" : "AM"); PrintSz(sz);
               }
           } else {
               sprintf(sz, "%2d:%02d %s\n", s1 > 12 ? s1 - 12 : s1, s2, s1 >= 12 ? "PM" : "AM"); PrintSz(sz);
           }
         } else {
-            PrintInDay(source[i], aspect[i], dest[i]);
+            PrintInDay(pei->source, pei->aspect, pei->dest);
         }
       } else {
-        if ((Lon == 122.00) && (Lat == 37.23)) { /* Sunnyvale */
-          if (source[i] != 21 && dest[i] != 21) {
+        if (fHome) { /* Home session shows all but Lagna events */
+          if (pei->source != 21 && pei->dest != 21) {
             // sprintf(sz, "%s ", SzDate(fYear || fProg ? l : Mon, j, yea0, fFalse)); PrintSz(sz);
             sprintf(sz, "%2d:%02d %s ", s1, s2, tch); PrintSz(sz);
-            PrintAspect(source[i], sign1[i],
-              (int)RSgn(cp1.dir[source[i]])+(int)RSgn(cp2.dir[source[i]]),
-              aspect[i], dest[i], sign2[i],
-              (int)RSgn(cp1.dir[dest[i]])+(int)RSgn(cp2.dir[dest[i]]),
+            PrintAspect(pei->source, pei->sign1,
+              (int)RSgn(cp1.dir[pei->source])+(int)RSgn(cp2.dir[pei->source]),
+              pei->aspect, pei->dest, pei->sign2,
+              (int)RSgn(cp1.dir[pei->dest])+(int)RSgn(cp2.dir[pei->dest]),
               (char)(fProg ? 'e' : 'd'));
-            PrintInDay(source[i], aspect[i], dest[i]);
+            PrintInDay(pei->source, pei->aspect, pei->dest);
           }
         }
       }
@@ -1081,11 +1108,108 @@ bool fProg;
 
   /* Recompute original chart placements as we've overwritten them. */
 
+  FreeEvents(&el);
   ciCore = ciMain; ciTwin = ciT;
   CastChart(fTrue);
 }
 
 
+#ifdef LOGAN
+/* Compute the Sun's hour angle and declination, in degrees, at the given */
+/* time of day at the chart location. This is a subprocedure of the -=    */
+/* sunrise search below, and the caller has restricted everything except  */
+/* the Sun, so casting the chart for it here doesn't take much time.      */
+
+void SunHourAngle(mon, day, yea, tim, prHA, prDec)
+int mon, day, yea;
+real tim, *prHA, *prDec;
+{
+  real lon, lat;
+
+  SetCI(ciCore, mon, day, yea, DegToDec(tim), Dst, Zon, Lon, Lat);
+  CastChartMask(fTrue, cmObj);
+  lon = RFromD(Mod(planet[oSun] - is.rSid));
+  lat = RFromD(planetalt[oSun]);
+  EclToEqu(&lon, &lat);
+  *prHA = Mod(DFromR(RA - lon));
+  if (*prHA > rDegHalf)
+    *prHA -= rDegMax;
+  *prDec = DFromR(lat);
+}
+
+
+/* Return the time of day the centre of the Sun reaches the given altitude */
+/* at the chart location, rising if the direction is negative and setting  */
+/* if positive. Each step finds the hour angle the Sun has to be at given  */
+/* its declination, and moves by the difference at 15 degrees an hour, so  */
+/* a few steps from noon get well within a second. Returns -1 if the Sun   */
+/* doesn't cross that altitude that way during the day, e.g. polar night.  */
+
+real RSunHorizon(mon, day, yea, rAlt, nDir)
+int mon, day, yea, nDir;
+real rAlt;
+{
+  real tim = 12.0, lat, ha, dec, h0, dt;
+  int i;
+
+  lat = RFromD(DecToDeg(Lat));
+  for (i = 0; i < 10; i++) {
+    SunHourAngle(mon, day, yea, tim, &ha, &dec);
+    h0 = (RSinD(rAlt) - RSin(lat)*RSinD(dec)) / (RCos(lat)*RCosD(dec));
+    if (h0 < -1.0 || h0 > 1.0)
+      return -1.0;
+    dt = (real)nDir*DFromR(RAcos(h0)) - ha;
+    if (dt > rDegHalf)
+      dt -= rDegMax;
+    else if (dt < -rDegHalf)
+      dt += rDegMax;
+    tim += dt / 15.0;
+    if (tim < 0.0 || tim >= 24.0)
+      return -1.0;
+    if (RAbs(dt) < 15.0/3600.0/10.0)
+      break;
+  }
+  return tim;
+}
+
+
+/* Add the Sun's rising, and its setting too if oppositions are among the */
+/* aspects (-A 2 or more), on the given day to a list of events, as done  */
+/* by the -d search with the -= switch. They're entered as the Sun's      */
+/* conjunction and opposition to the Ascendant, which the search would    */
+/* otherwise have found, and are displayed along with other objects       */
+/* crossing the Ascendant. The horizon is the altitude set with -=, -=r,  */
+/* -=u, or -=a, by default the Sun's centre on the geometric horizon like */
+/* the Ascendant crossing.                                                */
+
+void AddSunRiseEvents(pel, mon, day, yea)
+EL *pel;
+int mon, day, yea;
+{
+  byte rgfIgnore[objMax];
+  real tim;
+  int i, s;
+
+  /* Only the Sun is needed, so skip computing anything else. */
+
+  for (i = 0; i < objMax; i++) {
+    rgfIgnore[i] = ignore[i];
+    ignore[i] = i != oSun;
+  }
+  for (i = -1; i <= 1 && (i < 0 || us.nAsp >= aOpp); i += 2) {
+    tim = RSunHorizon(mon, day, yea, rSunAlt, i);
+    if (tim < 0.0)
+      continue;
+    s = SFromZ(planet[oSun]);
+    PAddEvent(pel, tim*60.0, oSun, i < 0 ? aCon : aOpp, oAsc, s,
+      i < 0 ? s : (s+5)%cSign+1);
+  }
+  for (i = 0; i < objMax; i++)
+    ignore[i] = rgfIgnore[i];
+}
+#endif /* LOGAN */
+
+
 /* Search through a month, year, or years, and print out the times of exact */
 /* transits where planets in the time frame make aspect to the planets in   */
 /* some other chart, as specified with the -t switch. To do this, we cast   */
@@ -1095,20 +1219,24 @@ bool fProg;
 void ChartTransitSearch(fProg)
 bool fProg;
 {
-  real planet3[objMax], house3[cSign+1], ret3[objMax], time[MAXINDAY];
+  real planet3[objMax], house3[cSign+1], ret3[objMax];
   char sz[cchSzDef];
-  int source[MAXINDAY], aspect[MAXINDAY], dest[MAXINDAY], sign[MAXINDAY],
-    isret[MAXINDAY], M1, M2, Y1, Y2, occurcount, div, i, j, k, s1, s2, s3;
+  EL el;
+  EI FPTR *pei;
+  int M1, M2, Y1, Y2, div, i, j, k, s1, s2, s3;
   real divsiz, daysiz, d, e1, e2, f1, f2;
   CI ciT;
+  CS cs;
 
   ciT = ciTwin;
+  el.rgei = NULL; el.cei = el.ceiMax = 0;
   for (i = 1; i <= cSign; i++)
     house3[i] = house[i];
   for (i = 1; i <= cObj; i++) {
     planet3[i] = planet[i];
     ret3[i] = ret[i];
   }
+  BeginChartStep(&cs, Lon2, Lat2);
 
   /* Hacks: Searching month number zero means to search the whole year    */
   /* instead, month by month. Searching a negative month means to search  */
@@ -1146,7 +1274,7 @@ bool fProg;
     }
     for (i = 1; i <= oNorm; i++)
       SwapN(ignore[i], ignore2[i]);
-    CastChart(fTrue);
+    CastChartStep(&cs, cmSearch);
     for (i = 1; i <= oNorm; i++)
       SwapN(ignore[i], ignore2[i]);
     for (i = 1; i <= cSign; i++)
@@ -1159,7 +1287,7 @@ bool fProg;
     /* Divide our month into segments and then search each segment in turn. */
 
     for (div = 1; div <= us.nDivision; div++) {
-      occurcount = 0;
+      el.cei = 0;
 
       /* Cast the chart for the ending time of the present segment, and */
       /* copy the start time chart from the previous end time chart.    */
@@ -1173,7 +1301,7 @@ bool fProg;
       }
       for (i = 1; i <= oNorm; i++)
         SwapN(ignore[i], ignore2[i]);
-      CastChart(fTrue);
+      CastChartStep(&cs, cmSearch);
       for (i = 1; i <= oNorm; i++)
         SwapN(ignore[i], ignore2[i]);
       for (i = 1; i <= cSign; i++) {
@@ -1213,68 +1341,54 @@ bool fProg;
             if (RAbs(f2) > rDegHalf)
               f2 -= RSgn(f2)*rDegMax;
             if (MinDistance(d, Midpoint(e1, e2)) < rDegQuad &&
-              RSgn(f1) != RSgn(f2) && occurcount < MAXINDAY) {
+              RSgn(f1) != RSgn(f2)) {
 
               /* Ok, we have found a transit. Now determine the time */
               /* and save this transit in our list to be printed.    */
 
-              source[occurcount] = j;
-              aspect[occurcount] = k;
-              dest[occurcount] = i;
-              time[occurcount] = RAbs(f1)/(RAbs(f1)+RAbs(f2))*divsiz +
-                (real)(div-1)*divsiz;
-              sign[occurcount] = (int)(Mod(
+              pei = PAddEvent(&el, RAbs(f1)/(RAbs(f1)+RAbs(f2))*divsiz +
+                (real)(div-1)*divsiz, j, k, i, (int)(Mod(
                 MinDistance(cp1.obj[j], Mod(d-rAspAngle[k])) <
                 MinDistance(cp2.obj[j], Mod(d+rAspAngle[k])) ?
-                d-rAspAngle[k] : d+rAspAngle[k])/30.0)+1;
-              isret[occurcount] = (int)RSgn(cp1.dir[j]) +
-                (int)RSgn(cp2.dir[j]);
-              occurcount++;
+                d-rAspAngle[k] : d+rAspAngle[k])/30.0)+1,
+                SFromZ(planet3[i]));
+              if (pei != NULL)
+                pei->ret = (int)RSgn(cp1.dir[j]) + (int)RSgn(cp2.dir[j]);
             }
           }
 
       /* After all transits located, sort them by time at which they occur. */
 
-      for (i = 1; i < occurcount; i++) {
-        j = i-1;
-        while (j >= 0 && time[j] > time[j+1]) {
-          SwapN(source[j], source[j+1]);
-          SwapN(aspect[j], aspect[j+1]);
-          SwapN(dest[j], dest[j+1]);
-          SwapR(&time[j], &time[j+1]);
-          SwapN(sign[j], sign[j+1]);
-          SwapN(isret[j], isret[j+1]);
-          j--;
-        }
-      }
+      SortEvents(&el);
 
       /* Now loop through list and display all the transits. */
 
-      for (i = 0; i < occurcount; i++) {
-        s1 = (_int)time[i]/24/60;
-        s3 = (_int)time[i]-s1*24*60;
+      for (i = 0; i < el.cei; i++) {
+        pei = &el.rgei[i];
+        s1 = (_int)pei->time/24/60;
+        s3 = (_int)pei->time-s1*24*60;
         s2 = s3/60;
         s3 = s3-s2*60;
         SetCI(ciSave, Mon2, s1+1, Yea2, DegToDec((real)
-          ((_int)time[i]-s1*24*60) / 60.0), Dst2, Zon2, Lon2, Lat2);
+          ((_int)pei->time-s1*24*60) / 60.0), Dst2, Zon2, Lon2, Lat2);
         sprintf(sz, "%s %s ",
           SzDate(Mon2, s1+1, Yea2, fFalse), SzTime(s2, s3)); PrintSz(sz);
-        PrintAspect(source[i], sign[i], isret[i], aspect[i],
-          dest[i], SFromZ(planet3[dest[i]]), (int)RSgn(ret3[dest[i]]),
+        PrintAspect(pei->source, pei->sign1, pei->ret, pei->aspect,
+          pei->dest, pei->sign2, (int)RSgn(ret3[pei->dest]),
           (char)(fProg ? 'u' : 't'));
 
         /* Check for a Solar, Lunar, or any other return. */
 
-        if (aspect[i] == aCon && source[i] == dest[i]) {
+        if (pei->aspect == aCon && pei->source == pei->dest) {
           AnsiColor(kWhite);
-          sprintf(sz, " (%s Return)", source[i] == oSun ? "Solar" :
-            (source[i] == oMoo ? "Lunar" : szObjName[source[i]]));
+          sprintf(sz, " (%s Return)", pei->source == oSun ? "Solar" :
+            (pei->source == oMoo ? "Lunar" : szObjName[pei->source]));
           PrintSz(sz);
         }
         PrintL();
 #ifdef INTERPRET
         if (us.fInterpret)
-          InterpretTransit(source[i], aspect[i], dest[i]);
+          InterpretTransit(pei->source, pei->aspect, pei->dest);
 #endif
         AnsiColor(kDefault);
       }
@@ -1283,6 +1397,7 @@ bool fProg;
 
   /* Recompute original chart placements as we've overwritten them. */
 
+  FreeEvents(&el);
   ciCore = ciMain; ciTwin = ciT;
   CastChart(fTrue);
 }
@@ -1298,19 +1413,22 @@ bool fProg;
 void ChartInDayHorizon()
 {
   char sz[cchSzDef];
-  int source[MAXINDAY], type[MAXINDAY], sign[MAXINDAY],
-    fRet[MAXINDAY], occurcount, division, div, s1, s2, i, j, fT;
-  real time[MAXINDAY], rgalt1[objMax], rgalt2[objMax], azialt[MAXINDAY],
+  EL el;
+  EI FPTR *pei;
+  int division, div, s1, s2, i, j, fT;
+  real rgalt1[objMax], rgalt2[objMax],
     azi1, azi2, alt1, alt2, lon, lat, mc1, mc2, xA, yA, xV, yV, d, k;
   CI ciT;
+  CS cs;
 
   fT = us.fSidereal; us.fSidereal = fFalse;
   lon = RFromD(Mod(Lon)); lat = RFromD(Lat);
   division = us.nDivision * 4;
-  occurcount = 0;
+  el.rgei = NULL; el.cei = el.ceiMax = 0;
+  BeginChartStep(&cs, Lon, Lat);
 
   ciT = ciTwin; ciCore = ciMain; ciCore.tim = 0.0;
-  CastChart(fTrue);
+  CastChartStep(&cs, cmSearch);
   mc2 = RFromD(planet[oMC]); k = RFromD(planetalt[oMC]);
   EclToEqu(&mc2, &k);
   for (i = 1; i <= cSign; i++) {
@@ -1328,7 +1446,7 @@ void ChartInDayHorizon()
 
   for (div = 1; div <= division; div++) {
     ciCore = ciMain; ciCore.tim = DegToDec(24.0*(real)div/(real)division);
-    CastChart(fTrue);
+    CastChartStep(&cs, cmSearch);
     mc1 = mc2;
     mc2 = RFromD(planet[oMC]); k = RFromD(planetalt[oMC]);
     EclToEqu(&mc2, &k);
@@ -1363,74 +1481,63 @@ void ChartInDayHorizon()
         d = RAbs(azi1 - (j > 2 ? rDegQuad : 270.0))/MinDistance(azi1, azi2);
         k = alt1 + d*(alt2-alt1);
       }
-      if (j && occurcount < MAXINDAY) {
-        source[occurcount] = i;
-        type[occurcount] = j;
-        time[occurcount] = 24.0*((real)(div-1)+d)/(real)division*60.0;
-        sign[occurcount] = (int)Mod(cp1.obj[i] +
-          d*MinDifference(cp1.obj[i], cp2.obj[i]))/30 + 1;
-        fRet[occurcount] = (int)RSgn(cp1.dir[i]) + (int)RSgn(cp2.dir[i]);
-        azialt[occurcount] = k;
-        ciSave = ciMain;
-        ciSave.tim = DegToDec(time[occurcount] / 60.0);
-        occurcount++;
+      if (j) {
+        pei = PAddEvent(&el, 24.0*((real)(div-1)+d)/(real)division*60.0,
+          i, j, 0, (int)Mod(cp1.obj[i] +
+          d*MinDifference(cp1.obj[i], cp2.obj[i]))/30 + 1, 0);
+        if (pei != NULL) {
+          pei->ret = (int)RSgn(cp1.dir[i]) + (int)RSgn(cp2.dir[i]);
+          pei->val = k;
+          ciSave = ciMain;
+          ciSave.tim = DegToDec(pei->time / 60.0);
+        }
       }
     }
   }
 
   /* Sort each event in order of time when it happens during the day. */
 
-  for (i = 1; i < occurcount; i++) {
-    j = i-1;
-    while (j >= 0 && time[j] > time[j+1]) {
-      SwapN(source[j], source[j+1]);
-      SwapN(type[j], type[j+1]);
-      SwapR(&time[j], &time[j+1]);
-      SwapN(sign[j], sign[j+1]);
-      SwapN(fRet[j], fRet[j+1]);
-      SwapR(&azialt[j], &azialt[j+1]);
-      j--;
-    }
-  }
+  SortEvents(&el);
 
   /* Finally display the list showing each event and when it occurs. */
 
-  for (i = 0; i < occurcount; i++) {
+  for (i = 0; i < el.cei; i++) {
+    pei = &el.rgei[i];
     ciSave = ciMain;
-    ciSave.tim = DegToDec(time[i] / 60.0);
+    ciSave.tim = DegToDec(pei->time / 60.0);
     j = DayOfWeek(Mon, Day, Yea);
     AnsiColor(kRainbowA[j + 1]);
     sprintf(sz, "(%c%c%c) ", chDay3(j)); PrintSz(sz);
     AnsiColor(kDefault);
-    s1 = (int)time[i]/60;
-    s2 = (int)time[i]-s1*60;
+    s1 = (int)pei->time/60;
+    s2 = (int)pei->time-s1*60;
     sprintf(sz, "%s %s ", SzDate(Mon, Day, Yea, fFalse), SzTime(s1, s2));
     PrintSz(sz);
-    AnsiColor(kObjA[source[i]]);
-    sprintf(sz, "%7.7s ", szObjName[source[i]]); PrintSz(sz);
-    AnsiColor(kSignA(sign[i]));
+    AnsiColor(kObjA[pei->source]);
+    sprintf(sz, "%7.7s ", szObjName[pei->source]); PrintSz(sz);
+    AnsiColor(kSignA(pei->sign1));
     sprintf(sz, "%c%c%c%c%c ",
-      fRet[i] > 0 ? '(' : (fRet[i] < 0 ? '[' : '<'), chSig3(sign[i]),
-      fRet[i] > 0 ? ')' : (fRet[i] < 0 ? ']' : '>')); PrintSz(sz);
-    AnsiColor(kElemA[type[i]-1]);
-    if (type[i] == 1)
+      pei->ret > 0 ? '(' : (pei->ret < 0 ? '[' : '<'), chSig3(pei->sign1),
+      pei->ret > 0 ? ')' : (pei->ret < 0 ? ']' : '>')); PrintSz(sz);
+    AnsiColor(kElemA[pei->aspect-1]);
+    if (pei->aspect == 1)
       PrintSz("rises  ");
-    else if (type[i] == 2)
+    else if (pei->aspect == 2)
       PrintSz("zeniths");
-    else if (type[i] == 3)
+    else if (pei->aspect == 3)
       PrintSz("sets   ");
     else
       PrintSz("nadirs ");
     AnsiColor(kDefault);
     PrintSz(" at ");
-    if (type[i] & 1) {
-      j = (int)(RFract(azialt[i])*60.0);
-      sprintf(sz, "%3d%c%02d'", (int)azialt[i], chDeg1, j); PrintSz(sz);
+    if (pei->aspect & 1) {
+      j = (int)(RFract(pei->val)*60.0);
+      sprintf(sz, "%3d%c%02d'", (int)pei->val, chDeg1, j); PrintSz(sz);
 
       /* For rising and setting events, we'll also display a direction  */
       /* vector to make the 360 degree azimuth value thought of easier. */
 
-      xA = RCosD(azialt[i]); yA = RSinD(azialt[i]);
+      xA = RCosD(pei->val); yA = RSinD(pei->val);
       if (RAbs(xA) < RAbs(yA)) {
         xV = RAbs(xA / yA); yV = 1.0;
       } else {
@@ -1439,12 +1546,13 @@ void ChartInDayHorizon()
       sprintf(sz, " (%.2f%c %.2f%c)",
         yV, yA < 0.0 ? 's' : 'n', xV, xA > 0.0 ? 'e' : 'w'); PrintSz(sz);
     } else
-      PrintAltitude(azialt[i]);
+      PrintAltitude(pei->val);
     PrintL();
   }
 
   /* Recompute original chart placements as we've overwritten them. */
 
+  FreeEvents(&el);
   ciCore = ciMain; ciTwin = ciT;
   us.fSidereal = fT;
   CastChart(fTrue);
@@ -1459,6 +1567,7 @@ void ChartEphemeris()
 {
   char sz[cchSzDef];
   int yea, yea1, yea2, mon, mon1, mon2, daysiz, i, j, s, d, m;
+  CS cs;
 
   /* If -Ey is in effect, then loop through all months in the whole year. */
 
@@ -1467,6 +1576,7 @@ void ChartEphemeris()
   } else {
     yea1 = yea2 = Yea; mon1 = mon2 = Mon;
   }
+  BeginChartStep(&cs, Lon, Lat);
 
   /* Loop through the year or years in question. */
 
@@ -1490,7 +1600,7 @@ void ChartEphemeris()
       /* Loop through each day in the month, casting a chart for that day. */
 
       SetCI(ciCore, mon, i, yea, Tim, Dst, Zon, Lon, Lat);
-      CastChart(fTrue);
+      CastChartStep(&cs, cmSearch);
       PrintSz(SzDate(mon, i, yea, -1));
       PrintCh(' ');
       for (j = 1; j <= cObj; j++)
@@ -99,12 +99,12 @@ US NPTR us = {
 
   /* Value subsettings */
 
-  4, 5, cPart, 0.0, 365.25, 1, 1, 24, 0L, 0};
+  4, 5, cPart, 0.0, 365.25, 1, 1, 0, 0L, 0, skText, 0};
 
 IS NPTR is = {
   fFalse, fFalse, fFalse, fFalse, fFalse, fFalse,
   NULL, NULL, NULL, NULL, NULL, NULL,
-  0, 0, 0, 0.0, 0.0, 0.0};
+  0, 0, 0, 0.0, 0.0, 0.0, NULL};
 
 CI ciCore = {11, 19, 1971, 11.01, 0.0, 8.0, 122.20, 47.36, "", ""};
 CI ciMain = {-1, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, "", ""};
@@ -112,6 +112,14 @@ CI ciTwin = {9, 11, 1991, 0.01, 0.0, 0.0, 122.20, 47.36, "", ""};
 CI ciSave = {8, 10, 1995, 11.16, 1.0, 8.0, 122.20, 47.36, "", ""};
 CP cp1, cp2;
 
+/* Market sessions the -d search can limit itself to, set with -YM switch. */
+
+MS rgms[MAXSESSION] = {
+  {"Sunnyvale", 122.00, 37.23, 8.00, 6.30, 13.00, fTrue},
+  {"Chicago",    87.39, 41.51, 6.00, 8.30, 15.00, fFalse},
+  {"New York",   74.00, 40.42, 5.00, 9.30, 16.00, fFalse}};
+int cms = 3;
+
 FILE *S; // = stdout;
 real T;
 
@@ -125,6 +133,9 @@ real T;
 real planet[objMax], planetalt[objMax], house[cSign+1], ret[objMax],
   spacex[oNorm+1], spacey[oNorm+1], spacez[oNorm+1], force[objMax];
 GridInfo FPTR *grid = NULL;
+AspectInfo FPTR *rgai = NULL;
+long (FPTR *rglAsp)[objMax] = NULL;
+int cai = 0, caiMax = 0;
 byte inhouse[objMax];
 int starname[cStar+1], kObjA[objMax];
 char *szMacro[48];
@@ -374,6 +385,35 @@ CONST real rObjAxis[oPlu+1] = {23.5, 0.0, 6.7,
 CONST byte cSatellite[oPlu+1] = {1, 9, 0,
   0, 0, 2, 16, 18, 15, 8, 1};
 
+/* Vedic graha tables, all expanded from GRAHADEF() in astrolog.h, */
+/* along with the graha ruling each rasi.                          */
+
+#define DgRasi(r, ex, de, o1, o2, fr, en) ((r) == (ex) ? dgExalted : \
+  ((r) == (de) ? dgDebilitated : ((r) == (o1) || (r) == (o2) ? dgOwn : \
+  ((r) == (fr) ? dgFriend : ((r) == (en) ? dgEnemy : dgNeutral)))))
+#define DgRow(ex, de, o1, o2, fr, en, fF, fE) { \
+  DgRasi(0, ex, de, o1, o2, fr, en), DgRasi(1, ex, de, o1, o2, fr, en), \
+  DgRasi(2, ex, de, o1, o2, fr, en), DgRasi(3, ex, de, o1, o2, fr, en), \
+  DgRasi(4, ex, de, o1, o2, fr, en), DgRasi(5, ex, de, o1, o2, fr, en), \
+  DgRasi(6, ex, de, o1, o2, fr, en), DgRasi(7, ex, de, o1, o2, fr, en), \
+  DgRasi(8, ex, de, o1, o2, fr, en), DgRasi(9, ex, de, o1, o2, fr, en), \
+  DgRasi(10, ex, de, o1, o2, fr, en), DgRasi(11, ex, de, o1, o2, fr, en)},
+#define ReBit(gr, fF, fE) ((fF) >> (gr) & 1 ? reFriend : \
+  ((fE) >> (gr) & 1 ? reEnemy : reNeutral))
+#define ReRow(ex, de, o1, o2, fr, en, fF, fE) { \
+  ReBit(0, fF, fE), ReBit(1, fF, fE), ReBit(2, fF, fE), ReBit(3, fF, fE), \
+  ReBit(4, fF, fE), ReBit(5, fF, fE), ReBit(6, fF, fE), ReBit(7, fF, fE), \
+  ReBit(8, fF, fE)},
+#define FriendRow(ex, de, o1, o2, fr, en, fF, fE) fF,
+#define EnemyRow(ex, de, o1, o2, fr, en, fF, fE) fE,
+
+CONST byte rgDignity[cGraha][cSign] = {GRAHADEF(DgRow)};
+CONST byte rgRelation[cGraha][cGraha] = {GRAHADEF(ReRow)};
+CONST word rgfGrahaFriend[cGraha] = {GRAHADEF(FriendRow)};
+CONST word rgfGrahaEnemy[cGraha] = {GRAHADEF(EnemyRow)};
+CONST byte rgLordRasi[cSign] = {grMar, grVen, grMer, grMoo, grSun, grMer,
+  grVen, grMar, grJup, grSat, grSat, grJup};
+
 #ifdef ARABIC
 CONST AI ai[cPart] = {
   {"    02 01F ", "Fortune"},
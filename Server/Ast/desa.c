@@ -13,12 +13,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <libgen.h>
-
-#define THURSDAY    4   /* for reformation */
-#define SATURDAY    6   /* 1 Jan 1 was a Saturday */
-
-#define FIRST_MISSING_DAY   639787    /* 3 Sep 1752 */
-#define NUMBER_MISSING_DAYS   11    /* 11 day correction */
+#include "astrolog.h"
 
 #define SUN         0
 #define MOON        1
@@ -30,8 +25,22 @@
 #define KETU        7
 #define VENUS       8
 
+/* Nakshatra and pada of a position in arc seconds, for NakshatraOf() and */
+/* NakshatraBatch() below, which everything else goes through.            */
+#define NakFromSec(l)     ((int)((l)/cSecNak))
+#define PadaFromSec(l)    ((int)((l)%cSecNak/cSecPada)+1)
+
 long Dasa[9];
 
+/* Years in each planet's dasa, and the dasa lord of each nakshatra */
+static int DasaYears[9] = { 6, 10, 7, 18, 16, 19, 17, 7, 20 };
+
+static byte NakLord[27] = {
+  KETU, VENUS, SUN, MOON, MARS, RAHU, JUPITER, SATURN, MERCURY,
+  KETU, VENUS, SUN, MOON, MARS, RAHU, JUPITER, SATURN, MERCURY,
+  KETU, VENUS, SUN, MOON, MARS, RAHU, JUPITER, SATURN, MERCURY
+};
+
 char Rasi[13][128];
 char Navamsa[13][128];
 
@@ -41,11 +50,11 @@ char *Pla[12] = {
   "LAGNA", "VAKRA", "NIL"
 };
 
-struct PerRelation {
-  int Friend[9];
-  int Neutral[9];
-  int Enemy[9];
-}PerPlanet[9];
+/* The graha each of the above is in astrolog.h's grSun to grKet order. */
+int GrPla[9] = {
+  grSun, grMoo, grMar, grRah, grJup,
+  grSat, grMer, grKet, grVen
+};
 
 struct ActRelation {
   int IntFriend[9];
@@ -55,11 +64,6 @@ struct ActRelation {
   int BitEnemy[9];
 }ActPlanet[9];
 
-static int days_in_month[2][13] = {
-  {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31},
-  {0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31}
-};
-
 char *month_names[12] = {
   "Jan", "Feb", "Mar", "Apr", "May", "Jun",
   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
@@ -69,57 +73,47 @@ char *week_names[7] = {
   "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
 };
 
-/* leap year -- account for gregorian reformation in 1752 */
-#define leap_year(yr) \
-  ((yr) <= 1752 ? !((yr) % 4) : \
-  !((yr) % 4) && ((yr) % 100) || !((yr) % 400))
-
-/* number of centuries since 1700, not inclusive */
-#define centuries_since_1700(yr) \
-  ((yr) > 1700 ? (yr) / 100 - 17 : 0)
-
-/* number of centuries since 1700 whose modulo of 400 is 0 */
-#define quad_centuries_since_1700(yr) \
-  ((yr) > 1600 ? ((yr) - 1600) / 400 : 0)
-
-/* number of leap years between year 1 and this year, not inclusive */
-#define leap_years_since_year_1(yr) \
-  ((yr) / 4 - centuries_since_1700(yr) + quad_centuries_since_1700(yr))
-
-static int b_days_passed;
-static int pb_days_passed;
-static int a_days_passed;
-static int d_days_passed;
-static int pa_days_passed;
-static int gflag;
-static int gflag1;
-static int lflag;
-static int lflag1;
-static int adj;
-static int adj1;
-static int req;
-static int req1;
+/* Names of the dasa lords as used in the report rows. */
+static char *DasaName[9] = {
+  "Sun's", "Moon's", "Mars's", "Rahu's", "Jupiter's",
+  "Saturn's", "Mercury's", "Ketu's", "Venus's"
+};
+
+static char *DasaLevel[dlSookshma + 1] = {
+  "Cycle", "Dasa", "Bhukti", "Antaram", "Pratyantar", "Sookshma"
+};
+
+static real rLocal;
 int antarams;
-int balance;
 int html;
 
-DasaMain(char *name, int day, int month, int year, int ruler, int b_day, int b_month, int b_year)
+/*
+ * DasaMain --
+ *  write the dasa/bhukti and the dasa/bhukti/antaram reports for a
+ *  birth, given its Julian day and the sidereal longitude of the Moon,
+ *  both rendered from the one timeline CreateDasaTimeline() builds
+ */
+void
+DasaMain(char *name, real jdBirth, real rMoon)
 {
-    int year_day;
+    DT *pdt;
 
-    InitDasa();
-    year_day = DayInYear(day, month, year);
-    balance = ((b_year * 12 * 30) + (b_month * 30) + b_day);
+    pdt = (DT *)PAllocate(sizeof(DT), fFalse, "dasa timeline");
+    if (pdt == NULL) {
+        return;
+    }
+    CreateDasaTimeline(pdt, jdBirth, rMoon);
+    rLocal = (DecToDeg(Dst) - DecToDeg(Zon)) / 24.0;
     antarams = 0;
-    PrintDasa(name, year, year_day, ruler);
+    PrintDasa(name, pdt, jdBirth);
     antarams = 1;
-    PrintDasa(name, year, year_day, ruler);
+    PrintDasa(name, pdt, jdBirth);
+    DeallocateFar(pdt);
 }
 
 #ifdef DESA_MAIN
 main(int argc, char *argv[])
 {
-    int year_day;
     int day;
     int month;
     int year;
@@ -127,6 +121,8 @@ main(int argc, char *argv[])
     int b_month;
     int b_year;
     int desa;
+    int nak;
+    real rMoon;
 
     if (argc == 1) {
         fprintf(stderr, "Usage %s filename\n", argv[0]);
@@ -134,7 +130,15 @@ main(int argc, char *argv[])
     }
 
     ReadFile(argv[1], &day, &month, &year, &desa, &b_day, &b_month, &b_year);
-    DasaMain(argv[1], day, month, year, desa, b_day, b_month, b_year); 
+
+    /* The file gives the dasa balance rather than the Moon, so put the */
+    /* Moon that far from the end of a nakshatra the lord rules.        */
+    for (nak = 0; NakLord[nak] != desa; nak++)
+        ;
+    rMoon = (nak + 1 - (b_year + b_month / 12.0 + b_day / rDasaYear) /
+        DasaYears[desa]) * (360.0 / 27.0);
+    DasaMain(argv[1], (real)MdyToJulian(month, day, year) - rRound +
+        (DecToDeg(Zon) - DecToDeg(Dst)) / 24.0, rMoon);
     RelMain(argv[1]); 
 }
 #endif
@@ -177,7 +181,6 @@ RelMain(char *fname)
         fprintf(stderr, "Unable to open file %s for writing\n", file_name);
         exit(1);
     }
-    IntPerRelation();
     PrintRelation(fp1, 1, Rasi);
     PrintRelation(fp1, 2, Navamsa);
     fclose(fp1);
@@ -185,43 +188,103 @@ RelMain(char *fname)
 
 InitDasa(void)
 {
-    Dasa[SUN] = 6;
-    Dasa[MOON] = 10;
-    Dasa[MARS] = 7;
-    Dasa[RAHU] = 18;
-    Dasa[JUPITER] = 16;
-    Dasa[SATURN] = 19;
-    Dasa[MERCURY] = 17;
-    Dasa[KETU] = 7;
-    Dasa[VENUS] = 20;
+    int i;
+
+    for (i = 0; i < 9; i++) {
+        Dasa[i] = DasaYears[i];
+    }
 }
 
-PrintDasa(char *fname, int year, int dob, int planet)
+/*
+ * DasaDate --
+ *  fill in the local date a Julian day falls on, and return the day
+ *  number of that date, for counting whole days between dates
+ */
+static long
+DasaDate(real jd, int *day, int *month, int *year)
+{
+    real r = RFloor(jd + rLocal + rRound);
+
+    JulianToMdy(r, month, day, year);
+    return (long)r;
+}
+
+/*
+ * PrintDasaRow --
+ *  write one period of a report: its lord, its length in calendar
+ *  years, months and days, the date it starts on, and the days from
+ *  the start of the period it's in to its end. Periods running at
+ *  birth are only counted from the day of birth.
+ */
+static void
+PrintDasaRow(FILE *fp1, int level, int lord, real jd1, real jd2,
+    real jdParent)
 {
     char name[128];
+    int d1, m1, y1, d2, m2, y2, days, months, years;
+    long l1, l2, lParent;
+
+    lParent = DasaDate(jdParent, &d2, &m2, &y2);
+    l1 = DasaDate(jd1, &d1, &m1, &y1);
+    l2 = DasaDate(jd2, &d2, &m2, &y2);
+    years = y2 - y1;
+    months = m2 - m1;
+    days = d2 - d1;
+    if (days < 0) {
+        months--;
+        days += DayInMonth(m2 > 1 ? m2 - 1 : 12, m2 > 1 ? y2 : y2 - 1);
+    }
+    if (months < 0) {
+        years--;
+        months += 12;
+    }
+
+    if (level == dlDasa) {
+        sprintf(name, "%s Dasa", DasaName[lord]);
+        fprintf(fp1, "\n");
+    } else if (level == dlBhukti) {
+        sprintf(name, " %s Bhuktis", DasaName[lord]);
+    } else {
+        sprintf(name, "  %s Antarams", DasaName[lord]);
+    }
+    if (html) {
+        fprintf(fp1, "%-20s - %2d %2d %2d", name, years, months, days);
+        fprintf(fp1, "   %3s %2d %2d\n", month_names[m1 - 1], d1, y1);
+    } else {
+        fprintf(fp1, "%-28s -  %2d %2d %2d %5ld", name, years, months, days,
+                l2 - l1);
+        fprintf(fp1, "   %3s %2d %2d  %-5s %5ld\n", month_names[m1 - 1], d1,
+                y1, week_names[(l1 + 1) % 7], level == dlDasa ? 0L :
+                l2 - lParent);
+    }
+}
+
+/*
+ * PrintDasa --
+ *  write the dasas of a timeline from birth to the end of its cycle,
+ *  with their bhuktis and, if antarams is set, their antarams, to
+ *  Data/Dasa or, for the name "html", to stdout. The header also gives
+ *  the periods running when the report is made, down to sookshmas.
+ */
+void
+PrintDasa(char *fname, DT *pdt, real jdBirth)
+{
     char file_name[128];
-    int t_planet;
-    int t_bhuktis;
-    int t_antarams;
-    int i;
-    int j;
-    int k;
-    int mod;
-    int div;
-    int b_days;
-    int b_months;
-    int b_years;
-    int b_temp;
-    int b_total;
-    int a_days;
-    int a_months;
-    int a_years;
-    int a_temp;
-    int a_total;
-    int temp;
-    long tm;
     char *tmp;
+    time_t tm;
     FILE *fp1;
+    DP dp;
+    DP *pdpD;
+    DP *pdpB;
+    DP *pdpA;
+    real jdD;
+    real jdB;
+    int idpD;
+    int idpB;
+    int idpA;
+    int cdpB;
+    int cdpA;
+    int level;
 
     time(&tm);
     if (antarams == 0) {
@@ -236,9 +299,17 @@ PrintDasa(char *fname, int year, int dob, int planet)
         sprintf(file_name, "Data/Dasa/%s%s", basename(fname), tmp);
         if ((fp1 = fopen(file_name, "w")) == NULL) {
             fprintf(stderr, "Unable to open file %s for writing\n", file_name);
-            exit(1);
+            return;
+        }
+        fprintf(fp1, "For %s Executed on %s", basename(fname), ctime(&tm));
+        fprintf(fp1, "Running now:");
+        for (level = dlDasa; level <= dlSookshma; level++) {
+            FDasaAt(&pdt->dpCycle, (real)tm / 86400.0 + 2440587.5, level,
+                &dp);
+            fprintf(fp1, "%s %s %s", level > dlDasa ? "," : "",
+                    DasaName[dp.nLord], DasaLevel[level]);
         }
-        fprintf(fp1, "For %s Executed on %s\n", basename(fname), ctime(&tm));
+        fprintf(fp1, "\n\n");
     }
     if (antarams ==  0) {
         if (html) {
@@ -260,302 +331,297 @@ PrintDasa(char *fname, int year, int dob, int planet)
     } else {
         fprintf(fp1, "         %-15s   \n", "Starting From");
     }
-    t_planet = 0;
-    b_days_passed = 0;
-    pb_days_passed = 0;
-    gflag = 0;
-    gflag1 = 0;
-    for (i = planet; t_planet < 9; t_planet++) {
-
-        a_days_passed = 0;
-        d_days_passed = 0;
-        pa_days_passed = 0;
-        lflag1 = 0;
-
-        PrintName(fp1, 1, i, name, 0, 0, Dasa[i], year, dob, 1);
-
-        t_bhuktis = 0;
-        b_total = 0;
-        temp = Dasa[i] * 12 * 30;
-
-        for (j = i; t_bhuktis < 9; t_bhuktis++) {
-
-            a_days_passed = 0;
-            pa_days_passed = 0;
-            lflag = 0;
-            b_temp = temp * Dasa[j] / 120;
-            DasaYearDayToDate(b_temp, &b_days, &b_months, &b_years);
-            if (i == planet) {
-                if ((gflag != 1) && ((b_total + b_temp) < (temp - balance))) {
-                    b_total += b_temp;
-                } else {
-                    if (gflag == 0) {
-                        gflag = 1;
-                        lflag1 = 1;
-                        adj = ((b_total + b_temp) - (temp - balance));
-                        req = (temp - balance) - b_total;
-                        PrintName(fp1, 2, j, name, b_days, b_months, b_years, 
-                                year, dob, 2);
-                    } else {
-                        PrintName(fp1, 2, j, name, b_days, b_months, b_years, 
-                                year, dob, 0);
-                    }
-                }
-            } else {
-                PrintName(fp1, 2, j, name, b_days, b_months, b_years, 
-                        year, dob, 0);
-            }
-            if (gflag == 1) {
-                if (antarams) {
-                    t_antarams = 0;
-                    a_total = 0;
-                    for (k = j; t_antarams < 9; t_antarams++) {
-                        a_temp = b_temp * Dasa[k] / 120;
-                        DasaYearDayToDate(a_temp, &a_days, &a_months, &a_years);
-                        if (i == planet) {
-                            if ((gflag1 != 1) && ((a_total + a_temp) < (b_temp - adj))) {
-                                a_total += a_temp;
-                            } else {
-                                if (gflag1 == 0) {
-                                    gflag1 = 1;
-                                    lflag = 1;
-                                    adj1 = ((a_total + a_temp) - (b_temp - adj));
-                                    req1 = (b_temp - adj) - a_total;
-                                    PrintName(fp1, 3, k, name, a_days, a_months,
-                                            a_years, year, dob, 3);
-                                } else {
-                                    PrintName(fp1, 3, k, name, a_days, a_months, 
-                                            a_years, year, dob, 0);
-                                }
-                            }
-                        } else {
-                            PrintName(fp1, 3, k, name, a_days, a_months, a_years, 
-                                    year, dob, 0);
-                        }
-                        pa_days_passed = a_days_passed;
-                        if (k == 8) {
-                            k = 0;
-                        } else {
-                            k++;
-                        }
-                    }
-                    fprintf(fp1, "\n");
-                }
-                pb_days_passed = b_days_passed;
+
+    idpD = IdpFindDasa(pdt, dlDasa, jdBirth);
+    if (idpD < 0) {
+        idpD = IdpDasaLevel(dlDasa);
+    }
+    for (; idpD < IdpDasaLevel(dlDasa) + CdpDasaLevel(dlDasa); idpD++) {
+        pdpD = &pdt->rgdp[idpD];
+        jdD = Max(pdpD->jdStart, jdBirth);
+        PrintDasaRow(fp1, dlDasa, pdpD->nLord, jdD, pdpD->jdEnd, jdD);
+        cdpB = CdpRangeDasa(pdt, dlBhukti, jdD, pdpD->jdEnd, &idpB);
+        for (; cdpB > 0; cdpB--, idpB++) {
+            pdpB = &pdt->rgdp[idpB];
+            jdB = Max(pdpB->jdStart, jdBirth);
+            PrintDasaRow(fp1, dlBhukti, pdpB->nLord, jdB, pdpB->jdEnd, jdD);
+            if (!antarams) {
+                continue;
             }
-            if (j == 8) {
-                j = 0;
-            } else {
-                j++;
+            cdpA = CdpRangeDasa(pdt, dlAntaram, jdB, pdpB->jdEnd, &idpA);
+            for (; cdpA > 0; cdpA--, idpA++) {
+                pdpA = &pdt->rgdp[idpA];
+                PrintDasaRow(fp1, dlAntaram, pdpA->nLord,
+                    Max(pdpA->jdStart, jdBirth), pdpA->jdEnd, jdB);
             }
-        }
-        if (i == 8) {
-            i = 0;
-        } else {
-            i++;
+            fprintf(fp1, "\n");
         }
     }
-    fclose(fp1);
+    if (fp1 != stdout) {
+        fclose(fp1);
+    }
 }
 
-PrintName(FILE *fp1, int flag, int planet, char *name, int days, int months, int years, int born_year, int dob, int flag1)
+/*
+ * NakshatraOf --
+ *  fill in the rasi, nakshatra, pada and dasa lord of a sidereal
+ *  longitude given in whole arc seconds, as LZodiacSec() returns it,
+ *  and how much of the lord's dasa is left, as the Moon's would be at
+ *  birth. Each nakshatra is cSecNak seconds and each pada cSecPada,
+ *  so this is all straight division. Everything else that wants the
+ *  nakshatra or pada of a position gets it from here or from
+ *  NakshatraBatch(), so they can't disagree.
+ *  The balance is also split into whole years, twelfths of a year
+ *  and days, with the same 365.25 day year the dasa timeline uses.
+ */
+void
+NakshatraOf(long lSec, NK *pnk)
 {
-    char str[128];
-    int dasa_day;
-    int dasa_month;
-    int dasa_year;
-    int week_day;
-    int days_in_year;
-    int temp;
-    int logan;
-
-    switch(planet) {
-    case SUN:
-        strcpy(str, "Sun's");
-        break;
-    case MOON:
-        strcpy(str, "Moon's");
-        break;
-    case MARS:
-        strcpy(str, "Mars's");
-        break;
-    case RAHU:
-        strcpy(str, "Rahu's");
-        break;
-    case JUPITER:
-        strcpy(str, "Jupiter's");
-        break;
-    case SATURN:
-        strcpy(str, "Saturn's");
-        break;
-    case MERCURY:
-        strcpy(str, "Mercury's");
-        break;
-    case KETU:
-        strcpy(str, "Ketu's");
-        break;
-    case VENUS:
-        strcpy(str, "Venus's");
-        break;
-    }
-
-    days_in_year = ((years * 12 * 30) + (months * 30) + (days));
-
-    if (flag == 1) {
-        sprintf(name, "%s Dasa", str);
-    } else if (flag == 2) {
-        sprintf(name, " %s Bhuktis", str);
-        b_days_passed += days_in_year;
-        d_days_passed += days_in_year;
-    } else if (flag == 3) {
-        sprintf(name, "  %s Antarams", str);
-        a_days_passed += days_in_year;
-    }
-
-    if (flag1 == 0) {
-        if (pb_days_passed == 0)
-            YearDayToDate(born_year, dob + pa_days_passed - req1, 
-                    &dasa_day, &dasa_month, &dasa_year);
-        else
-            YearDayToDate(born_year, dob + pb_days_passed + pa_days_passed - req, 
-                    &dasa_day, &dasa_month, &dasa_year);
-    } else if (flag1 == 1) {
-        if (gflag == 0) {
-            YearDayToDate(born_year, dob, &dasa_day, &dasa_month, &dasa_year);
-            DasaYearDayToDate(balance, &days, &months, &years);
-        } else {
-            YearDayToDate(born_year, dob + pb_days_passed + pa_days_passed - req, 
-                    &dasa_day, &dasa_month, &dasa_year);
-        }
-    } else if (flag1 == 2) {
-        YearDayToDate(born_year, dob, &dasa_day, &dasa_month, &dasa_year);
-        DasaYearDayToDate(adj, &days, &months, &years);
-    } else if (flag1 == 3) {
-        YearDayToDate(born_year, dob, &dasa_day, &dasa_month, &dasa_year);
-        DasaYearDayToDate(adj1, &days, &months, &years);
-    }
-#ifdef DEBUG
-    fprintf(stderr, "dob = %d, pb_days_passed = %d, pa_days_passed = %d,"
-                    "adj = %d, adj1 = %d, req = %d, req1 = %d\n", 
-                dob, pb_days_passed, pa_days_passed, adj, adj1, req, req1);
-#endif
-    if (antarams == 1) {
-        if (lflag == 1) {
-            logan = a_days_passed - req1;
-        } else {
-            logan = a_days_passed;
+    real val;
+
+    lSec %= cSecCircle;
+    pnk->rasi = RasiFromSec(lSec) - 1;
+    pnk->nak = NakFromSec(lSec);
+    pnk->pada = PadaFromSec(lSec);
+    pnk->lord = NakLord[pnk->nak];
+    pnk->secLeft = cSecNak - lSec % cSecNak;
+    pnk->rBalance = (real)pnk->secLeft / cSecNak * DasaYears[pnk->lord];
+
+    val = pnk->rBalance;
+    pnk->years = (int)val;
+    val = (val - pnk->years) * 12;
+    pnk->months = (int)val;
+    pnk->days = (int)((val - pnk->months) * rDasaYear / 12.0);
+}
+
+/*
+ * NakshatraBatch --
+ *  the same as NakshatraOf() over an array of longitudes in arc
+ *  seconds, into a separate array for each value, for all the bodies
+ *  of a chart or batch jobs over many charts. Any of the result arrays
+ *  may be NULL. There are no branches in the loops, so they can be
+ *  vectorized.
+ */
+void
+NakshatraBatch(CONST long *rglSec, int c, byte *rgnak, byte *rgpada,
+    byte *rglord, real *rgbal)
+{
+    long l;
+    int i;
+
+    if (rgnak != NULL) {
+        for (i = 0; i < c; i++) {
+            rgnak[i] = (byte)NakFromSec(rglSec[i] % cSecCircle);
         }
-    } else {
-        if (lflag1 == 1) {
-            logan = d_days_passed - req;
-        } else {
-            logan = d_days_passed;
+    }
+    if (rgpada != NULL) {
+        for (i = 0; i < c; i++) {
+            rgpada[i] = (byte)PadaFromSec(rglSec[i]);
         }
     }
-    week_day = DayInWeek(dasa_day, dasa_month, dasa_year);
-    if (flag == 1) {
-        fprintf(fp1, "\n");
+    if (rglord != NULL) {
+        for (i = 0; i < c; i++) {
+            rglord[i] = NakLord[NakFromSec(rglSec[i] % cSecCircle)];
+        }
     }
-    if (html) {
-        fprintf(fp1, "%-20s - %2d %2d %2d", name, years, months, days);
-        fprintf(fp1, "   %3s %2d %2d\n", month_names[dasa_month - 1], 
-                dasa_day, dasa_year);
-    } else {
-        fprintf(fp1, "%-28s -  %2d %2d %2d %5d", name, years, months, days,
-                ((years * 360) + (months * 30) + days));
-        fprintf(fp1, "   %3s %2d %2d  %-5s %5d\n", month_names[dasa_month - 1], 
-                dasa_day, dasa_year, week_names[week_day], logan);
+    if (rgbal != NULL) {
+        for (i = 0; i < c; i++) {
+            l = rglSec[i] % cSecCircle;
+            rgbal[i] = (real)(cSecNak - l % cSecNak) / cSecNak *
+                DasaYears[NakLord[NakFromSec(l)]];
+        }
     }
 }
 
 /*
- * DayInYear --
- *  return the 1 based day number within the year
+ * DasaCycle --
+ *  fill in the 120 year cycle of dasas a birth falls in, given the
+ *  Julian day of birth and the sidereal longitude of the Moon. The
+ *  cycle starts with the dasa of the lord of the Moon's nakshatra,
+ *  back by however much of it had run at birth, worked out from the
+ *  exact longitude rather than a balance rounded to whole days.
  */
-DayInYear(int day, int month, int year)
+void
+DasaCycle(real jdBirth, real rMoon, DP *pdp)
 {
-    int i, leap;
+    real rNak;
+    int nak;
 
-    leap = leap_year(year);
-    for (i = 1; i < month; i++) {
-        day += days_in_month[leap][i];
+    InitDasa();
+    rNak = (rMoon - 360.0 * floor(rMoon / 360.0)) / (360.0 / 27.0);
+    nak = (int)rNak;
+    if (nak > 26) {
+        nak = 26;
     }
-    return (day);
+    pdp->nLord = NakLord[nak];
+    pdp->nLevel = dlCycle;
+    pdp->jdStart = jdBirth -
+        (rNak - nak) * Dasa[pdp->nLord] * rDasaYear;
+    pdp->jdEnd = pdp->jdStart + 120.0 * rDasaYear;
 }
 
 /*
- * Dasa YearDayToDate --
- *
+ * DasaChild --
+ *  fill in the k'th (0 to 8) period at the next level down within a
+ *  period. The last ends exactly when its parent does, and each one
+ *  ends exactly where the one after it starts.
  */
-DasaYearDayToDate(int year_day, int *days, int *months, int *years)
+void
+DasaChild(DP *pdpParent, int k, DP *pdp)
 {
-    int temp;
+    real len = pdpParent->jdEnd - pdpParent->jdStart;
+    long cum = 0;
+    int i;
 
-    *days = year_day % 30;
-    temp = year_day / 30;
-    *months = temp % 12;
-    *years = temp / 12;
-    temp = ((*years * 12 * 30) + (*months * 30) + *days);
-    if (temp != year_day) {
-        fprintf(stderr, " *** Temp = %d, year_day = %d\n", temp, year_day);
+    for (i = 0; i < k; i++) {
+        cum += Dasa[(pdpParent->nLord + i) % 9];
+    }
+    pdp->nLord = (pdpParent->nLord + k) % 9;
+    pdp->nLevel = pdpParent->nLevel + 1;
+    pdp->jdStart = pdpParent->jdStart + len * cum / 120.0;
+    if (k < 8) {
+        pdp->jdEnd = pdpParent->jdStart +
+            len * (cum + Dasa[pdp->nLord]) / 120.0;
+    } else {
+        pdp->jdEnd = pdpParent->jdEnd;
     }
 }
 
 /*
- * YearDayToDate --
- *  return the 1 based day number within the year
+ * FDasaAt --
+ *  find the period at the given level (dlDasa down to dlSookshma) in
+ *  effect at a Julian day, working down from the cycle filled in by
+ *  DasaCycle(). Only the periods along the way are computed, so this
+ *  is as cheap at the deepest level as at the first. Cycles repeat
+ *  every 120 years, so days outside the birth's cycle work too.
  */
-YearDayToDate(int year_year, int year_day, int *day, int *month, int *year)
+bool
+FDasaAt(DP *pdpCycle, real jd, int level, DP *pdp)
 {
-    int i, leap;
-    int days;
-
-    while (1) {
-        leap = leap_year(year_year);
-        days = 0;
-        for (i = 1; i < 13; i++) {
-            days += days_in_month[leap][i];
-            if (year_day <= days) {
-                days = days_in_month[leap][i] - (days - year_day);
+    DP dp;
+    real len;
+    int k;
+
+    if (level < dlCycle || level > dlSookshma) {
+        return fFalse;
+    }
+    dp = *pdpCycle;
+    len = dp.jdEnd - dp.jdStart;
+    if (jd < dp.jdStart || jd >= dp.jdEnd) {
+        dp.jdStart += floor((jd - dp.jdStart) / len) * len;
+        dp.jdEnd = dp.jdStart + len;
+    }
+    *pdp = dp;
+    while (pdp->nLevel < level) {
+        dp = *pdp;
+        for (k = 0; k < 8; k++) {
+            DasaChild(&dp, k, pdp);
+            if (jd < pdp->jdEnd) {
                 break;
             }
         }
-        if (i == 13) {
-            year_year++;
-            year_day = year_day - days;
-        } else {
-            break;
+        if (k == 8) {
+            DasaChild(&dp, 8, pdp);
         }
     }
-    *day = days;
-    *month = i;
-    *year = year_year;
-    return (1);
+    return fTrue;
 }
 
 /*
- * DayInWeek
- *  return the 0 based day number for any date from 1 Jan. 1 to
- *  31 Dec. 9999.  Assumes the Gregorian reformation eliminates
- *  3 Sep. 1752 through 13 Sep. 1752.  Returns Thursday for all
- *  missing days.
+ * CreateDasaTimeline --
+ *  build the dasa, bhukti and antaram periods of the cycle a birth
+ *  falls in, given the same values as DasaCycle()
  */
-DayInWeek(int day, int month, int year)
+void
+CreateDasaTimeline(DT *pdt, real jdBirth, real rMoon)
 {
-    long temp;
-
-    temp = (long)(year - 1) * 365 + leap_years_since_year_1(year - 1) 
-        + DayInYear(day, month, year);
+    DP *pdpD;
+    DP *pdpB;
+    DP *pdpA;
+    int i;
+    int j;
+    int k;
 
-    if (temp < FIRST_MISSING_DAY) {
-        return ((temp - 1 + SATURDAY) % 7);
+    DasaCycle(jdBirth, rMoon, &pdt->dpCycle);
+    pdpD = &pdt->rgdp[IdpDasaLevel(dlDasa)];
+    pdpB = &pdt->rgdp[IdpDasaLevel(dlBhukti)];
+    pdpA = &pdt->rgdp[IdpDasaLevel(dlAntaram)];
+    for (i = 0; i < 9; i++, pdpD++) {
+        DasaChild(&pdt->dpCycle, i, pdpD);
+        for (j = 0; j < 9; j++, pdpB++) {
+            DasaChild(pdpD, j, pdpB);
+            for (k = 0; k < 9; k++, pdpA++) {
+                DasaChild(pdpB, k, pdpA);
+            }
+        }
     }
+}
+
+/*
+ * IdpFindDasa --
+ *  return the index in a dasa timeline of the period at the given
+ *  level (dlDasa, dlBhukti or dlAntaram) in effect at a Julian day,
+ *  or -1 if the day is outside the timeline's cycle
+ */
+int
+IdpFindDasa(DT *pdt, int level, real jd)
+{
+    int lo = IdpDasaLevel(level);
+    int hi = lo + CdpDasaLevel(level);
+    int i;
 
-    if (temp >= (FIRST_MISSING_DAY + NUMBER_MISSING_DAYS)) {
-        return (((temp - 1 + SATURDAY) - NUMBER_MISSING_DAYS) % 7);
+    if (jd < pdt->rgdp[lo].jdStart || jd >= pdt->rgdp[hi - 1].jdEnd) {
+        return(-1);
+    }
+    while (lo < hi) {
+        i = (lo + hi) >> 1;
+        if (pdt->rgdp[i].jdEnd <= jd) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
     }
+    return(lo);
+}
 
-    return (THURSDAY);
+/*
+ * CdpRangeDasa --
+ *  find the periods at one level that overlap the time from the first
+ *  Julian day up to but not including the second. The index of the
+ *  first is returned in the pointer parameter, and the count of them
+ *  is the return value.
+ */
+int
+CdpRangeDasa(DT *pdt, int level, real jd1, real jd2, int *pidp)
+{
+    int base = IdpDasaLevel(level);
+    int lo;
+    int hi;
+    int i;
+    int idp1;
+
+    lo = base;
+    hi = base + CdpDasaLevel(level);
+    while (lo < hi) {
+        i = (lo + hi) >> 1;
+        if (pdt->rgdp[i].jdEnd <= jd1) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    idp1 = lo;
+    hi = base + CdpDasaLevel(level);
+    while (lo < hi) {
+        i = (lo + hi) >> 1;
+        if (pdt->rgdp[i].jdStart < jd2) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+    *pidp = idp1;
+    return(jd2 > jd1 ? lo - idp1 : 0);
 }
 
 PrintRelation(FILE *fp1, int rasi, char tRasi[13][128])
@@ -656,114 +722,28 @@ upper(char *str)
     }
 }
 
-IntPerRelation(void)
-{
-    int i;
-    int j;
-
-    for (i = 0; i < 9; i++) {
-        for (j = 0; j < 9; j++) {
-            PerPlanet[i].Friend[j] = -1;
-            PerPlanet[i].Neutral[j] = -1;
-            PerPlanet[i].Enemy[j] = -1;
-        }
-    }
-
-    /* For SUN */
-    PerPlanet[SUN].Friend[MOON] = 1;
-    PerPlanet[SUN].Friend[MARS] = 1;
-    PerPlanet[SUN].Friend[JUPITER] = 1;
-
-    PerPlanet[SUN].Neutral[MERCURY] = 1;
-
-    PerPlanet[SUN].Enemy[SATURN] = 1;
-    PerPlanet[SUN].Enemy[VENUS] = 1;
-
-    /* For MOON */
-    PerPlanet[MOON].Friend[SUN] = 1;
-    PerPlanet[MOON].Friend[MERCURY] = 1;
-
-    PerPlanet[MOON].Neutral[MARS] = 1;
-    PerPlanet[MOON].Neutral[JUPITER] = 1;
-    PerPlanet[MOON].Neutral[SATURN] = 1;
-    PerPlanet[MOON].Neutral[VENUS] = 1;
-
-    /* For MARS */
-    PerPlanet[MARS].Friend[JUPITER] = 1;
-    PerPlanet[MARS].Friend[MOON] = 1;
-    PerPlanet[MARS].Friend[SUN] = 1;
-
-    PerPlanet[MARS].Neutral[SATURN] = 1;
-    PerPlanet[MARS].Neutral[VENUS] = 1;
-
-    PerPlanet[MARS].Enemy[MERCURY] = 1;
-
-    /* For MERCURY */
-    PerPlanet[MERCURY].Friend[SUN] = 1;
-    PerPlanet[MERCURY].Friend[VENUS] = 1;
-
-    PerPlanet[MERCURY].Neutral[SATURN] = 1;
-    PerPlanet[MERCURY].Neutral[MARS] = 1;
-    PerPlanet[MERCURY].Neutral[JUPITER] = 1;
-
-    PerPlanet[MERCURY].Enemy[MOON] = 1;
-
-    /* For JUPITER */
-    PerPlanet[JUPITER].Friend[SUN] = 1;
-    PerPlanet[JUPITER].Friend[MOON] = 1;
-    PerPlanet[JUPITER].Friend[MARS] = 1;
-
-    PerPlanet[JUPITER].Neutral[SATURN] = 1;
-
-    PerPlanet[JUPITER].Enemy[MERCURY] = 1;
-    PerPlanet[JUPITER].Enemy[VENUS] = 1;
-
-    /* For VENUS */
-    PerPlanet[VENUS].Friend[MERCURY] = 1;
-    PerPlanet[VENUS].Friend[SATURN] = 1;
-
-    PerPlanet[VENUS].Neutral[MARS] = 1;
-    PerPlanet[VENUS].Neutral[JUPITER] = 1;
-
-    PerPlanet[VENUS].Enemy[MOON] = 1;
-    PerPlanet[VENUS].Enemy[SUN] = 1;
-
-    /* For SATURN */
-    PerPlanet[SATURN].Friend[VENUS] = 1;
-    PerPlanet[SATURN].Friend[MERCURY] = 1;
-
-    PerPlanet[SATURN].Neutral[JUPITER] = 1;
-
-    PerPlanet[SATURN].Enemy[MARS] = 1;
-    PerPlanet[SATURN].Enemy[MOON] = 1;
-    PerPlanet[SATURN].Enemy[SUN] = 1;
-}
-
+/*
+ * IsFriend, IsNeutral, IsEnemy --
+ *  return 1 if planet i naturally counts planet j as a friend, neutral,
+ *  or an enemy, from the graha relationship table, else -1. A planet is
+ *  none of these to itself.
+ */
 IsFriend(int i, int j)
 {
-    if (PerPlanet[i].Friend[j] == 1) {
-        return(1);
-    } else {
-        return(-1);
-    }
+    return(ReGraha(GrPla[i], GrPla[j]) == reFriend ? 1 : -1);
 }
 
 IsNeutral(int i, int j)
 {
-    if (PerPlanet[i].Neutral[j] == 1) {
-        return(1);
-    } else {
+    if (i == j) {
         return(-1);
     }
+    return(ReGraha(GrPla[i], GrPla[j]) == reNeutral ? 1 : -1);
 }
 
 IsEnemy(int i, int j)
 {
-    if (PerPlanet[i].Enemy[j] == 1) {
-        return(1);
-    } else {
-        return(-1);
-    }
+    return(ReGraha(GrPla[i], GrPla[j]) == reEnemy ? 1 : -1);
 }
 
 distance(int ind1, int ind2)
@@ -93,12 +93,17 @@ extern US NPTR us;
 extern IS NPTR is;
 extern CI ciCore, ciMain, ciTwin, ciSave;
 extern CP cp1, cp2;
+extern MS rgms[MAXSESSION];
+extern int cms;
 extern FILE *S;
 extern real MC, Asc, T, RA;
 
 extern real planet[objMax], planetalt[objMax], house[cSign+1], ret[objMax],
   spacex[oNorm+1], spacey[oNorm+1], spacez[oNorm+1], force[objMax];
 extern GridInfo FPTR *grid;
+extern AspectInfo FPTR *rgai;
+extern long (FPTR *rglAsp)[objMax];
+extern int cai, caiMax;
 extern byte inhouse[objMax];
 extern int starname[cStar+1], kObjA[objMax];
 
@@ -128,6 +133,9 @@ extern char *szMindPart[oNorm+1], *szDesc[cSign+1], *szDesire[cSign+1],
 extern CONST real rObjDist[oVes+1], rObjYear[oVes+1], rObjDiam[oVes+1],
   rObjDay[oPlu+1], rObjMass[oPlu+1], rObjAxis[oPlu+1];
 extern CONST byte cSatellite[oPlu+1];
+extern CONST byte rgDignity[cGraha][cSign], rgRelation[cGraha][cGraha],
+  rgLordRasi[cSign];
+extern CONST word rgfGrahaFriend[cGraha], rgfGrahaEnemy[cGraha];
 extern CONST AI ai[cPart];
 
 extern CONST byte rErrorCount[oPlu-oJup+1];
@@ -144,6 +152,7 @@ extern CONST char *szColor[cColor];
 #define ErrorValR(sz, r) ErrorValN(sz, (int)r)
 
 extern void SwapR P((real *, real *));
+extern void SwapEvent P((EI FPTR *, EI FPTR *));
 extern int CchSz P((CONST char *));
 extern int NCompareSz P((CONST char *, CONST char *));
 extern void ClearB P((lpbyte, int));
@@ -160,6 +169,8 @@ extern real MinDistance P((real, real));
 extern real MinDifference P((real, real));
 extern real Midpoint P((real, real));
 extern char Dignify P((int, int));
+extern void GrahaDignities P((CONST byte *, CONST byte *, int, byte *,
+  byte *));
 extern int DayInMonth P((int, int));
 extern int DaysInMonth P((int, int));
 extern int DayOfWeek P((int, int, int));
@@ -168,6 +179,7 @@ extern real GetOrb P((int, int, int));
 extern void Terminate P((int));
 extern void PrintSz P((CONST char *));
 extern void PrintCh P((char));
+extern void InitPrintBuffer P((void));
 extern void PrintSzScreen P((char *));
 extern void PrintNotice P((char *));
 extern void PrintWarning P((char *));
@@ -193,6 +205,9 @@ extern int NFromAltN P((int));
 extern char *ProcessProgname P((char *));
 extern char *SzPersist P((char *));
 extern lpbyte PAllocate P((long, bool, char *));
+extern EI FPTR *PAddEvent P((EL *, real, int, int, int, int, int));
+extern void SortEvents P((EL *));
+extern void FreeEvents P((EL *));
 
 
 /* From io.c */
@@ -211,6 +226,7 @@ extern bool FInputData P((char *));
 /* From calc.c */
 
 #define RBiorhythm(day, rate) (RSin(((day)/(rate))*rPi2)*100.0)
+#define cmSearch (us.fFlip ? cmAll : cmAll & ~cmHouse)
 
 extern int HousePlaceIn P((real));
 extern void ComputeInHouses P((void));
@@ -223,14 +239,28 @@ extern void ComputeHouses P((int));
 extern void ComputeStars P((real));
 extern real Decan P((real));
 extern void SphToRec P((real, real, real, real *, real *, real *));
-extern void ComputePlacalc P((real));
+extern void ComputePlacalc P((real, bool));
 extern real CastChart P((bool));
+extern real CastChartMask P((bool, int));
+extern void BeginChartStep P((CS *, real, real));
+extern real CastChartStep P((CS *, int));
+extern bool FCastChartBatch P((CI *, int, byte *, CB *));
+extern void FreeChartBatch P((CB *));
+extern void ChartBenchmark P((int));
+extern void CastHouseBatch P((real, CONST real *, CONST real *, int, real *,
+  real *, real *));
 extern bool FEnsureGrid P((void));
+extern bool FEnsureAspectPairs P((void));
 extern bool FAcceptAspect P((int, int, int));
-extern void GetAspect P((real *, real *, real *, real *, int, int));
+extern int NGetAspect P((real *, real *, real *, real *, int, int, long,
+  real *, bool *));
+extern void GetAspect P((real *, real *, real *, real *, int, int, long));
+extern int NGetParallel P((real *, real *, real *, real *, int, int, real *));
 extern void GetParallel P((real *, real *, real *, real *, int, int));
+extern void MarkAspectPairs P((real *, real *, long [objMax][objMax]));
 extern bool FCreateGrid P((bool));
 extern bool FCreateGridRelation P((bool));
+extern bool FCreateAspectList P((void));
 extern void CreateElemTable P((ET *));
 
 
@@ -240,6 +270,7 @@ extern void CreateElemTable P((ET *));
 #define EquToEcl(Z, L) CoorXform(Z, L, RFromD(-rAxis))
 #define EquToLocal(Z, L, T) CoorXform(Z, L, T)
 #define JulianDayFromTime(t) ((t)*36525.0+2415020.0)
+#define RTanLat() (is.pcs != NULL ? is.pcs->rTanLat : RTan(AA))
 #define IoeFromObj(obj) \
   (obj < oMoo ? 0 : (obj <= cPlanet ? obj-2 : obj-uranLo+cPlanet-1))
 #define Tropical(deg) (deg - is.rSid + us.rZodiacOffset)
@@ -249,6 +280,7 @@ extern real MC, Asc, RA, OB;
 extern long MdyToJulian P((int, int, int));
 extern real MdytszToJulian P((int, int, int, real, real, real));
 extern void JulianToMdy P((real, int *, int *, int *));
+extern real RSiderealOffset P((real));
 extern real ProcessInput P((bool));
 extern void PolToRec P((real, real, real *, real *));
 extern void RecToPol P((real, real, real *, real *));
@@ -259,6 +291,8 @@ extern real CuspMidheaven P((void));
 extern real CuspAscendant P((void));
 extern real CuspEastPoint P((void));
 extern real CuspPlacidus P((real, real, bool));
+extern void CuspPlacidusBatch P((real, real, bool, real *, real *, real *,
+  int));
 extern void HousePlacidus P((void));
 extern void HouseKoch P((void));
 extern void HouseEqual P((void));
@@ -270,7 +304,8 @@ extern void HouseMorinus P((void));
 extern real CuspTopocentric P((real));
 extern void HouseTopocentric P((void));
 extern real ReadThree P((real, real, real));
-extern void RecToSph2 P((real, real, real, real *, real *, real *));
+extern void RecToSph2 P((real *, real *, real *, real *));
+extern void SolveKepler P((real *, real *, real *, int));
 extern void ErrorCorrect P((int, real *, real *, real *));
 extern void ProcessPlanet P((int, real));
 extern void ComputePlanets P((void));
@@ -351,12 +386,84 @@ extern void DisplayRelation P((void));
 
 /* From charts3.c */
 
+extern bool FAspectInReach P((real, real, real *, int));
+extern void CastInDaySegment P((CS *, int, int, real, bool));
+extern int ImsInSession P((int *, int, real, int));
+extern bool FInSession P((int *, int, real, real, real));
 extern void ChartInDaySearch P((bool));
+extern long LZodiacSec P((real));
+extern int IRasiDms P((real, int *, int *, int *));
+extern int VargaFromSec P((long, int));
+extern void VargaBatch P((CONST long *, int, CONST int *, int, byte *));
+extern void SunHourAngle P((int, int, int, real, real *, real *));
+extern real RSunHorizon P((int, int, int, real, int));
+extern void AddSunRiseEvents P((EL *, int, int, int));
 extern void ChartTransitSearch P((bool));
 extern void ChartInDayHorizon P((void));
 extern void ChartEphemeris P((void));
 
 
+/* From panchang.c */
+
+extern char szPanchangMagic[4];
+extern int rgcPanchang[cPanchang], rgiPanchang[cPanchang];
+extern char *szPanchangKind[cPanchang];
+extern void PanchangState P((real, real *));
+extern real JdPanchangCross P((int, real, real, real, real));
+extern bool FWritePanchang P((char *, real, real));
+extern PN *PnOpenPanchang P((char *));
+extern void ClosePanchang P((PN *));
+extern int IpeFindPanchang P((PN *, real));
+extern int CpeRangePanchang P((PN *, real, real, int *));
+extern PE FPTR *PpeNextPanchang P((PN *, real, int));
+extern char *SzPanchangPeriod P((int));
+extern char *SzPanchangDate P((real));
+extern void ChartPanchang P((char *, real, int));
+
+
+/* From desa.c */
+
+extern int GrPla[cGraha];
+extern void DasaMain P((char *, real, real));
+extern void PrintDasa P((char *, DT *, real));
+extern void NakshatraOf P((long, NK *));
+extern void NakshatraBatch P((CONST long *, int, byte *, byte *, byte *,
+  real *));
+extern void DasaCycle P((real, real, DP *));
+extern void DasaChild P((DP *, int, DP *));
+extern bool FDasaAt P((DP *, real, int, DP *));
+extern void CreateDasaTimeline P((DT *, real, real));
+extern int IdpFindDasa P((DT *, int, real));
+extern int CdpRangeDasa P((DT *, int, real, real, int *));
+
+
+/* From match.c */
+
+extern char *szKuta[cKuta];
+extern byte rgbMatchNak[cNak][cNak], rgbMatchRasi[cSign][cSign];
+extern int NKuta P((int, int, int, int, int));
+extern void InitMatchTables P((void));
+extern int IAddMatch P((MT *, long, real, bool));
+extern void FreeMatch P((MT *));
+extern int IprFindMatch P((MT *, long));
+extern int NMatchPair P((MT *, int, int, int *));
+extern void AddMatchResult P((MR FPTR *, int *, int, int, int));
+extern void *PvMatchScan P((void *));
+extern int CMatchBest P((MT *, int, MR FPTR *, int, int));
+
+
+/* From sink.c */
+
+extern char szSinkMagic[4], *szSinkGraha[cGraha], *szSinkKind[4];
+extern CONST char *SzSinkAspect P((int));
+extern void SinkRecord P((CONST SR *));
+extern void SinkPosition P((real, int));
+extern void SinkAspect P((int, int, int, real, real));
+extern void SinkEvent P((real, CONST EI *));
+extern void SinkDasa P((CONST DP *));
+extern void SinkChart P((void));
+
+
 /* From intrpret.c */
 
 #ifdef INTERPRET
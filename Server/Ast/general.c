@@ -35,6 +35,10 @@
 */
 
 #include "astrolog.h"
+#include <string.h>
+#ifndef PC
+#include <unistd.h>
+#endif
 
 
 /*
@@ -54,6 +58,17 @@ real *d1, *d2;
 }
 
 
+/* Swap two event records, as found by the -d, -t, and -Zd searches. */
+
+void SwapEvent(pei1, pei2)
+EI FPTR *pei1, FPTR *pei2;
+{
+  EI ei;
+
+  ei = *pei1; *pei1 = *pei2; *pei2 = ei;
+}
+
+
 /* Return the length of a string (not counting the null terminator). */
 
 int CchSz(sz)
@@ -156,11 +171,13 @@ real d;
 real ModRad(r)
 real r;
 {
-  while (r >= rPi2)    /* We assume our value is only slightly out of       */
-    r -= rPi2;         /* range, so test and never do any complicated math. */
-  while (r < 0.0)
-    r += rPi2;
-  return r;
+  if (r >= rPi2)           /* As with Mod(), handle values slightly out of */
+    r -= rPi2;             /* range cheaply, but fall back on a division   */
+  else if (r < 0.0)        /* for values many revolutions away, such as    */
+    r += rPi2;             /* raw mean anomalies, rather than looping.     */
+  if (r >= 0.0 && r < rPi2)
+    return r;
+  return (r - RFloor(r/rPi2)*rPi2);
 }
 
 
@@ -285,6 +302,27 @@ int obj, sign;
 }
 
 
+/* Given lists of Vedic grahas and the rasi each is in, look up each one's */
+/* natural dignity there, and how it regards the graha ruling that rasi.   */
+/* This is only table lookups, with no output, so it's safe to use when    */
+/* evaluating a whole batch of charts. Either result array may be NULL.    */
+
+void GrahaDignities(rggr, rgrasi, c, rgdg, rgre)
+CONST byte *rggr, *rgrasi;
+int c;
+byte *rgdg, *rgre;
+{
+  int i;
+
+  if (rgdg != NULL)
+    for (i = 0; i < c; i++)
+      rgdg[i] = DgGraha(rggr[i], rgrasi[i]);
+  if (rgre != NULL)
+    for (i = 0; i < c; i++)
+      rgre[i] = ReGraha(rggr[i], rgLordRasi[rgrasi[i]]);
+}
+
+
 /* Determine the number of days in a particular month. The year is needed, */
 /* too, because we have to check for leap years in the case of February.   */
 
@@ -416,13 +454,30 @@ int tc;
 /* keep track of what column we are printing at after each newline so we  */
 /* can automatically clip at the appropriate point, and we keep track of  */
 /* the row we are printing at, so we may prompt before screen scrolling.  */
+/* When neither clipping nor scroll prompts are on, as in batch runs, no  */
+/* character needs anything done to it on its own, so the string is just  */
+/* written all at once, and memchr() finds newlines to keep the counts.   */
 
 void PrintSz(sz)
 CONST char *sz;
 {
   char szInput[cchSzDef], *pch;
 #ifndef WIN
+  CONST char *pchEnd, *pchLine;
   int nT;
+
+  if (!us.fClip80 && (us.nScrollRow <= 0 || S != stdout)) {
+    pchEnd = sz + strlen(sz);
+    fwrite(sz, 1, pchEnd - sz, S);
+    for (pchLine = sz; (pch = (char *)memchr(pchLine, '\n',
+      pchEnd - pchLine)) != NULL; pchLine = pch + 1)
+      is.cchRow++;
+    if (pchLine == sz)
+      is.cchCol += (int)(pchEnd - sz);
+    else
+      is.cchCol = (int)(pchEnd - pchLine);
+    return;
+  }
 #endif
 
   for (pch = (char *)sz; *pch; pch++) {
@@ -490,6 +545,24 @@ char ch;
 }
 
 
+/* Give standard output a big buffer when it goes to a file or pipe rather */
+/* than a terminal, as text charts written in bulk can run to megabytes.   */
+/* A terminal keeps its usual line buffering, so prompts still show up.    */
+/* Since setvbuf() can only be used on a stream before anything else,      */
+/* this is called first thing in main(). astromain() doesn't call it, as   */
+/* rasi runs that in a child process after stdout has already been used.   */
+
+void InitPrintBuffer()
+{
+#ifndef PC
+  static char rgchBuf[cchPrintBuf];
+
+  if (!isatty(fileno(stdout)))
+    setvbuf(stdout, rgchBuf, _IOFBF, cchPrintBuf);
+#endif
+}
+
+
 /* Print a string on the screen. Unlike the normal PrintSz(), here we still */
 /* go to the standard output even if text is being sent to a file with -os. */
 
@@ -1056,4 +1129,98 @@ char *szType;
   return lp;
 }
 
+
+/* Append a new event to the end of an event list, as built up by the -d, */
+/* -t, and -Zd searches, growing the list's storage by doubling it when   */
+/* it's full, so there's no limit to the number of events in one period.  */
+/* Returns the new event so callers can fill in any other fields, or NULL */
+/* if there's no memory left, in which case a warning has been printed.   */
+
+EI FPTR *PAddEvent(pel, time, source, aspect, dest, sign1, sign2)
+EL *pel;
+real time;
+int source, aspect, dest, sign1, sign2;
+{
+  EI FPTR *pei;
+  int cei;
+
+  if (pel->cei >= pel->ceiMax) {
+    cei = pel->ceiMax > 0 ? pel->ceiMax*2 : MAXINDAY;
+    pei = (EI FPTR *)PAllocate(sizeof(EI)*(long)cei, fFalse, "event list");
+    if (pei == NULL)
+      return NULL;
+    if (pel->rgei != NULL) {
+      CopyRgb((byte *)pel->rgei, (byte *)pei, sizeof(EI)*pel->cei);
+      DeallocateFar(pel->rgei);
+    }
+    pel->rgei = pei; pel->ceiMax = cei;
+  }
+  pei = &pel->rgei[pel->cei++];
+  pei->time = time; pei->val = 0.0;
+  pei->source = source; pei->aspect = aspect; pei->dest = dest;
+  pei->sign1 = sign1; pei->sign2 = sign2; pei->ret = 0;
+  return pei;
+}
+
+
+/* Sort an event list by the time each event happens at. This is a stable  */
+/* bottom up merge sort, so events at the same time stay in the order they */
+/* were found in, and big lists such as a busy day with many objects don't */
+/* take quadratic time. If there's no memory for the merge buffer, we fall */
+/* back to an insertion sort, which is slower but needs no extra space.    */
+
+void SortEvents(pel)
+EL *pel;
+{
+  EI FPTR *rgei, FPTR *rgeiT, FPTR *rgeiAlloc, FPTR *pei;
+  int cei = pel->cei, cRun, iLo, iMid, iHi, i, j, k;
+
+  if (cei < 2)
+    return;
+  rgeiAlloc = (EI FPTR *)PAllocate(sizeof(EI)*(long)cei, fFalse, NULL);
+  if (rgeiAlloc == NULL) {
+    for (i = 1; i < cei; i++) {
+      j = i-1;
+      while (j >= 0 && pel->rgei[j].time > pel->rgei[j+1].time) {
+        SwapEvent(&pel->rgei[j], &pel->rgei[j+1]);
+        j--;
+      }
+    }
+    return;
+  }
+
+  /* Merge adjacent runs of doubling size, ping ponging between the two */
+  /* buffers, and taking from the left run first when times are equal.  */
+
+  rgei = pel->rgei; rgeiT = rgeiAlloc;
+  for (cRun = 1; cRun < cei; cRun <<= 1) {
+    for (iLo = 0; iLo < cei; iLo += cRun << 1) {
+      iMid = Min(iLo + cRun, cei); iHi = Min(iLo + (cRun << 1), cei);
+      i = iLo; j = iMid; k = iLo;
+      while (i < iMid && j < iHi)
+        rgeiT[k++] = rgei[j].time < rgei[i].time ? rgei[j++] : rgei[i++];
+      while (i < iMid)
+        rgeiT[k++] = rgei[i++];
+      while (j < iHi)
+        rgeiT[k++] = rgei[j++];
+    }
+    pei = rgei; rgei = rgeiT; rgeiT = pei;
+  }
+  if (rgei != pel->rgei)
+    CopyRgb((byte *)rgei, (byte *)pel->rgei, sizeof(EI)*cei);
+  DeallocateFar(rgeiAlloc);
+}
+
+
+/* Deallocate the storage used by an event list, leaving it empty. */
+
+void FreeEvents(pel)
+EL *pel;
+{
+  if (pel->rgei != NULL)
+    DeallocateFar(pel->rgei);
+  pel->rgei = NULL;
+  pel->cei = pel->ceiMax = 0;
+}
+
 /* general.c */
@@ -0,0 +1,427 @@
+/*
+** Astrolog (Version 5.05) File: match.c
+**
+** IMPORTANT NOTICE: The graphics database and chart display routines
+** used in this program are Copyright (C) 1991-1995 by Walter D. Pullen
+** (astara@u.washington.edu). Permission is granted to freely use and
+** distribute these routines provided one doesn't sell, restrict, or
+** profit from them in any way. Modification is allowed provided these
+** notices remain with any altered or edited versions of the program.
+**
+** Horoscope matching: the eight Ashtakoota kutas between a groom and a
+** bride, scored from each one's Moon nakshatra and rasi. All the kutas
+** depend on either the two nakshatras or the two rasis, so every pair is
+** scored ahead of time into a 27 by 27 and a 12 by 12 table, and matching
+** one profile against many candidates is just two lookups for each.
+*/
+
+#include "astrolog.h"
+
+#ifdef THREADS
+#include <pthread.h>
+#endif
+
+#define MATCHTHREADMAX 64  /* Most threads a candidate scan is split over. */
+
+typedef struct _MatchJob {
+  MT *pmt;         /* Store being scanned.                         */
+  int ipr;         /* Profile candidates are matched with.         */
+  int iLo, iHi;    /* Range of candidates this job scans.          */
+  int cmr;         /* Most results to keep.                        */
+  int c;           /* Number of results kept so far.               */
+  MR FPTR *rgmr;   /* The results, best first.                     */
+} MJ;
+
+char *szKuta[cKuta] = {"Varna", "Vashya", "Tara", "Yoni",
+  "Graha Maitri", "Gana", "Bhakoot", "Nadi"};
+
+/* Totals of each pair of nakshatras, and of each pair of rasis, over the */
+/* kutas that depend on them, groom first. Filled in by                   */
+/* InitMatchTables().                                                     */
+
+byte rgbMatchNak[cNak][cNak], rgbMatchRasi[cSign][cSign];
+_bool fMatchInit = fFalse;
+
+/* Yoni animal of each nakshatra: Horse, Elephant, Sheep, Serpent, Dog, */
+/* Cat, Rat, Cow, Buffalo, Tiger, Deer, Monkey, Mongoose, and Lion.     */
+
+byte rgYoniNak[cNak] = {0, 1, 2, 3, 3, 4, 5, 2, 5, 6, 6, 7, 8, 9, 8, 9,
+  10, 10, 4, 11, 12, 11, 13, 0, 13, 7, 1};
+
+byte rgnYoni[14][14] = {
+  {4, 2, 2, 3, 2, 2, 2, 1, 0, 1, 3, 3, 2, 1},
+  {2, 4, 3, 3, 2, 2, 2, 2, 3, 1, 2, 3, 2, 0},
+  {2, 3, 4, 2, 1, 2, 1, 3, 3, 1, 2, 0, 3, 1},
+  {3, 3, 2, 4, 2, 1, 1, 1, 1, 2, 2, 2, 0, 2},
+  {2, 2, 1, 2, 4, 2, 1, 2, 2, 1, 0, 2, 1, 1},
+  {2, 2, 2, 1, 2, 4, 0, 2, 2, 1, 3, 3, 2, 1},
+  {2, 2, 1, 1, 1, 0, 4, 2, 2, 2, 2, 2, 1, 2},
+  {1, 2, 3, 1, 2, 2, 2, 4, 3, 0, 3, 2, 2, 1},
+  {0, 3, 3, 1, 2, 2, 2, 3, 4, 1, 2, 2, 2, 1},
+  {1, 1, 1, 2, 1, 1, 2, 0, 1, 4, 1, 1, 2, 1},
+  {3, 2, 2, 2, 0, 3, 2, 3, 2, 1, 4, 2, 2, 1},
+  {3, 3, 0, 2, 2, 3, 2, 2, 2, 1, 2, 4, 3, 2},
+  {2, 2, 3, 0, 1, 2, 1, 2, 2, 2, 2, 3, 4, 2},
+  {1, 0, 1, 2, 1, 1, 2, 1, 1, 1, 1, 2, 2, 4}};
+
+/* Gana of each nakshatra: Deva, Manushya, or Rakshasa, and the half */
+/* points each groom's gana gets with each bride's.                  */
+
+byte rgGanaNak[cNak] = {0, 1, 2, 1, 0, 1, 0, 0, 2, 2, 1, 1, 0, 2, 0, 2,
+  0, 2, 2, 1, 1, 0, 2, 2, 1, 1, 0};
+
+byte rgnGana[3][3] = {{12, 12, 0}, {10, 12, 0}, {2, 0, 12}};
+
+/* Varna of each rasi, from Shudra to Brahmin, and the rasis each one */
+/* holds as vashya, as a bit for each.                                */
+
+byte rgVarnaRasi[cSign] = {2, 1, 0, 3, 2, 1, 0, 3, 2, 1, 0, 3};
+
+int rgVashyaRasi[cSign] = {
+  1 << 4 | 1 << 7, 1 << 3 | 1 << 6, 1 << 5, 1 << 7 | 1 << 8,
+  1 << 6, 1 << 11 | 1 << 2, 1 << 9 | 1 << 5, 1 << 3,
+  1 << 11, 1 << 0 | 1 << 10, 1 << 0, 1 << 9};
+
+
+/*
+******************************************************************************
+** Kuta Scoring.
+******************************************************************************
+*/
+
+/* Return the half points a groom and bride with the given Moon           */
+/* nakshatras and rasis (both counted from 0) get for one kuta. The       */
+/* nakshatra kutas ignore the rasis and the rasi kutas ignore the         */
+/* nakshatras.                                                            */
+
+int NKuta(ku, nak1, rasi1, nak2, rasi2)
+int ku, nak1, rasi1, nak2, rasi2;
+{
+  int n, n1, n2;
+
+  switch (ku) {
+  case kuVarna:
+    return rgVarnaRasi[rasi1] >= rgVarnaRasi[rasi2] ? 2 : 0;
+  case kuVashya:
+    if (rasi1 == rasi2)
+      return 4;
+    return ((rgVashyaRasi[rasi1] >> rasi2 & 1) +
+      (rgVashyaRasi[rasi2] >> rasi1 & 1)) * 2;
+
+  /* Tara counts nakshatras from each side's to the other's. Counts that */
+  /* fall 3rd, 5th, or 7th within a group of 9 are unlucky.              */
+
+  case kuTara:
+    n = 0;
+    n1 = (nak1 - nak2 + cNak) % cNak % 9;
+    n2 = (nak2 - nak1 + cNak) % cNak % 9;
+    n += n1 != 2 && n1 != 4 && n1 != 6;
+    n += n2 != 2 && n2 != 4 && n2 != 6;
+    return n * 3;
+  case kuYoni:
+    return rgnYoni[rgYoniNak[nak1]][rgYoniNak[nak2]] * 2;
+  case kuMaitri:
+    n1 = rgLordRasi[rasi1]; n2 = rgLordRasi[rasi2];
+    if (n1 == n2)
+      return 10;
+    n = ReGraha(n1, n2); n2 = ReGraha(n2, n1);
+    switch (n + n2) {
+    case 4: return 10;
+    case 3: return 8;
+    case 2: return n == 1 ? 6 : 2;
+    case 1: return 1;
+    }
+    return 0;
+  case kuGana:
+    return rgnGana[rgGanaNak[nak1]][rgGanaNak[nak2]];
+
+  /* Bhakoot is lost when the rasis are 2/12, 5/9, or 6/8 apart. */
+
+  case kuBhakoot:
+    n = (rasi1 - rasi2 + cSign) % cSign;
+    n = Min(n, cSign - n);
+    return n == 1 || n == 4 || n == 5 ? 0 : 14;
+
+  /* Nadi goes Adi, Madhya, Antya, and back, over each 6 nakshatras. */
+
+  case kuNadi:
+    n1 = nak1 % 6; n2 = nak2 % 6;
+    return Min(n1, 5 - n1) == Min(n2, 5 - n2) ? 0 : 16;
+  }
+  return 0;
+}
+
+
+/* Fill in the nakshatra and rasi match tables from NKuta(). This only */
+/* needs to be done once, before the first scan.                       */
+
+void InitMatchTables()
+{
+  int i, j, ku, n;
+
+  for (i = 0; i < cNak; i++)
+    for (j = 0; j < cNak; j++) {
+      n = 0;
+      for (ku = 0; ku < cKuta; ku++)
+        if (!FKutaRasi(ku))
+          n += NKuta(ku, i, 0, j, 0);
+      rgbMatchNak[i][j] = (byte)n;
+    }
+  for (i = 0; i < cSign; i++)
+    for (j = 0; j < cSign; j++) {
+      n = 0;
+      for (ku = 0; ku < cKuta; ku++)
+        if (FKutaRasi(ku))
+          n += NKuta(ku, 0, i, 0, j);
+      rgbMatchRasi[i][j] = (byte)n;
+    }
+  fMatchInit = fTrue;
+}
+
+
+/*
+******************************************************************************
+** Profile Store.
+******************************************************************************
+*/
+
+/* Add a profile to a match store, given its Moon position, growing the */
+/* columns by doubling them when they're full. Returns the index of the */
+/* new profile, or -1 if there's no memory left, after a warning.       */
+
+int IAddMatch(pmt, id, rMoon, fMale)
+MT *pmt;
+long id;
+real rMoon;
+bool fMale;
+{
+  long FPTR *rgId;
+  byte FPTR *pb;
+  NK nk;
+  int cpr, i;
+
+  if (pmt->cpr >= pmt->cprMax) {
+    cpr = pmt->cprMax > 0 ? pmt->cprMax*2 : 1024;
+    rgId = (long FPTR *)PAllocate(sizeof(long)*(long)cpr, fTrue,
+      "match store");
+    pb = PAllocate(4L*cpr, fTrue, "match store");
+    if (rgId == NULL || pb == NULL) {
+      if (rgId != NULL)
+        DeallocateFar(rgId);
+      if (pb != NULL)
+        DeallocateFar(pb);
+      return -1;
+    }
+    if (pmt->rgId != NULL) {
+      CopyRgb((byte *)pmt->rgId, (byte *)rgId, sizeof(long)*pmt->cpr);
+      CopyRgb(pmt->rgNak,  pb,         pmt->cpr);
+      CopyRgb(pmt->rgRasi, pb + cpr,   pmt->cpr);
+      CopyRgb(pmt->rgPada, pb + cpr*2, pmt->cpr);
+      CopyRgb(pmt->rgMale, pb + cpr*3, pmt->cpr);
+      DeallocateFar(pmt->rgId);
+      DeallocateFar(pmt->rgNak);
+    }
+    pmt->rgId = rgId;
+    pmt->rgNak = pb; pmt->rgRasi = pb + cpr;
+    pmt->rgPada = pb + cpr*2; pmt->rgMale = pb + cpr*3;
+    pmt->cprMax = cpr;
+  }
+
+  /* Reduce the Moon with LZodiacSec() just as the Vedic listing does. */
+
+  NakshatraOf(LZodiacSec(rMoon), &nk);
+  i = pmt->cpr++;
+  pmt->rgId[i] = id;
+  pmt->rgNak[i] = (byte)nk.nak;
+  pmt->rgRasi[i] = (byte)nk.rasi;
+  pmt->rgPada[i] = (byte)nk.pada;
+  pmt->rgMale[i] = (byte)(fMale != fFalse);
+  return i;
+}
+
+
+/* Release the columns of a match store, leaving it empty. */
+
+void FreeMatch(pmt)
+MT *pmt;
+{
+  if (pmt->rgId != NULL) {
+    DeallocateFar(pmt->rgId);
+    DeallocateFar(pmt->rgNak);
+  }
+  ClearB((lpbyte)pmt, sizeof(MT));
+}
+
+
+/* Return the index of the profile in a match store with the given id, */
+/* or -1 if there isn't one.                                           */
+
+int IprFindMatch(pmt, id)
+MT *pmt;
+long id;
+{
+  int i;
+
+  for (i = 0; i < pmt->cpr; i++)
+    if (pmt->rgId[i] == id)
+      return i;
+  return -1;
+}
+
+
+/* Score two profiles in a match store against each other, whichever one */
+/* is the groom. If an array is passed, each kuta's half points are put  */
+/* there too, in kuVarna through kuNadi order. Returns the total.        */
+
+int NMatchPair(pmt, ipr1, ipr2, rgn)
+MT *pmt;
+int ipr1, ipr2, *rgn;
+{
+  int ku, n = 0, i;
+
+  if (!pmt->rgMale[ipr1] && pmt->rgMale[ipr2]) {
+    i = ipr1; ipr1 = ipr2; ipr2 = i;
+  }
+  for (ku = 0; ku < cKuta; ku++) {
+    i = NKuta(ku, pmt->rgNak[ipr1], pmt->rgRasi[ipr1],
+      pmt->rgNak[ipr2], pmt->rgRasi[ipr2]);
+    if (rgn != NULL)
+      rgn[ku] = i;
+    n += i;
+  }
+  return n;
+}
+
+
+/*
+******************************************************************************
+** Candidate Ranking.
+******************************************************************************
+*/
+
+/* Add a candidate to a list of the best ones so far, which is kept       */
+/* sorted by score, if it's better than the worst one there or there's    */
+/* still room. Candidates already in the list stay ahead of later ones    */
+/* with the same score, so when they're added in index order so are ties. */
+
+void AddMatchResult(rgmr, pc, cmr, ipr, nScore)
+MR FPTR *rgmr;
+int *pc, cmr, ipr, nScore;
+{
+  int i;
+
+  if (*pc >= cmr) {
+    if (cmr <= 0 || nScore <= rgmr[cmr-1].nScore)
+      return;
+    i = cmr-1;
+  } else
+    i = (*pc)++;
+  for (; i > 0 && rgmr[i-1].nScore < nScore; i--)
+    rgmr[i] = rgmr[i-1];
+  rgmr[i].ipr = ipr;
+  rgmr[i].nScore = nScore;
+}
+
+
+/* Scan one job's range of candidates for the best matches with its   */
+/* profile. The profile's row and column of the tables are pulled out */
+/* first, so each candidate is then just two lookups and an add.      */
+
+void *PvMatchScan(pv)
+void *pv;
+{
+  MJ *pmj = (MJ *)pv;
+  MT *pmt = pmj->pmt;
+  byte rgbNak[cNak], rgbRasi[cSign], fMale, nMin = 0;
+  int nak, rasi, n, i;
+
+  fMale = pmt->rgMale[pmj->ipr];
+  nak = pmt->rgNak[pmj->ipr]; rasi = pmt->rgRasi[pmj->ipr];
+  for (i = 0; i < cNak; i++)
+    rgbNak[i] = fMale ? rgbMatchNak[nak][i] : rgbMatchNak[i][nak];
+  for (i = 0; i < cSign; i++)
+    rgbRasi[i] = fMale ? rgbMatchRasi[rasi][i] : rgbMatchRasi[i][rasi];
+
+  for (i = pmj->iLo; i < pmj->iHi; i++) {
+    if (pmt->rgMale[i] == fMale)
+      continue;
+    n = rgbNak[pmt->rgNak[i]] + rgbRasi[pmt->rgRasi[i]];
+    if (pmj->c >= pmj->cmr && n <= nMin)
+      continue;
+    AddMatchResult(pmj->rgmr, &pmj->c, pmj->cmr, i, n);
+    if (pmj->c >= pmj->cmr)
+      nMin = pmj->rgmr[pmj->cmr-1].nScore;
+  }
+  return NULL;
+}
+
+
+/* Find the best matches for one profile among all the candidates of the  */
+/* other sex in a match store, as many as there's room for in the array,  */
+/* best first. The store is split into even ranges scanned on up to the   */
+/* given number of threads, and their lists are merged at the end, so the */
+/* results are the same however many threads are used. Returns the count. */
+
+int CMatchBest(pmt, ipr, rgmr, cmr, cThread)
+MT *pmt;
+int ipr;
+MR FPTR *rgmr;
+int cmr, cThread;
+{
+  MJ rgmj[MATCHTHREADMAX];
+  MR FPTR *rgmrT = NULL;
+  int c = 0, i, j;
+#ifdef THREADS
+  pthread_t rgth[MATCHTHREADMAX];
+  _bool rgf[MATCHTHREADMAX];
+#endif
+
+  if (!fMatchInit)
+    InitMatchTables();
+  if (ipr < 0 || ipr >= pmt->cpr || cmr <= 0)
+    return 0;
+  cThread = Max(Min(cThread, MATCHTHREADMAX), 1);
+  cThread = Max(Min(cThread, pmt->cpr / 4096), 1);
+  if (cThread > 1) {
+    rgmrT = (MR FPTR *)PAllocate(sizeof(MR)*(long)cmr*cThread, fTrue, NULL);
+    if (rgmrT == NULL)
+      cThread = 1;
+  }
+  for (i = 0; i < cThread; i++) {
+    rgmj[i].pmt = pmt;
+    rgmj[i].ipr = ipr;
+    rgmj[i].iLo = (int)((long)pmt->cpr * i / cThread);
+    rgmj[i].iHi = (int)((long)pmt->cpr * (i+1) / cThread);
+    rgmj[i].cmr = cmr;
+    rgmj[i].c = 0;
+    rgmj[i].rgmr = cThread > 1 ? rgmrT + (long)cmr*i : rgmr;
+  }
+  if (cThread <= 1) {
+    PvMatchScan(&rgmj[0]);
+    return rgmj[0].c;
+  }
+
+#ifdef THREADS
+  for (i = 1; i < cThread; i++)
+    rgf[i] = pthread_create(&rgth[i], NULL, PvMatchScan, &rgmj[i]) == 0;
+  PvMatchScan(&rgmj[0]);
+  for (i = 1; i < cThread; i++) {
+    if (rgf[i])
+      pthread_join(rgth[i], NULL);
+    else
+      PvMatchScan(&rgmj[i]);
+  }
+#else
+  for (i = 0; i < cThread; i++)
+    PvMatchScan(&rgmj[i]);
+#endif
+
+  /* Ranges are in index order, so merging in turn keeps ties in order. */
+
+  for (i = 0; i < cThread; i++)
+    for (j = 0; j < rgmj[i].c; j++)
+      AddMatchResult(rgmr, &c, cmr, rgmj[i].rgmr[j].ipr,
+        rgmj[i].rgmr[j].nScore);
+  DeallocateFar(rgmrT);
+  return c;
+}
@@ -113,6 +113,22 @@ int *mon, *day, *yea;
 }
 
 
+/* Return the offset in degrees between the tropical and sidereal zodiacs */
+/* at time T, in Julian centuries since 1900, as used by ProcessInput()   */
+/* and CastHouseBatch().                                                  */
+
+real RSiderealOffset(t)
+real t;
+{
+  real Off, Ln;
+
+  Ln = Mod((933060-6962911*t+7.5*t*t)/3600.0);    /* Mean lunar node */
+  Off = (259205536.0*t+2013816.0)/3600.0;         /* Mean Sun        */
+  Off = 17.23*RSin(RFromD(Ln))+1.27*RSin(RFromD(Off))-(5025.64+1.11*t)*t;
+  return (Off-84038.27)/3600.0;
+}
+
+
 /* This is a subprocedure of CastChart(). Once we have the chart parameters, */
 /* calculate a few important things related to the date, i.e. the Greenwich  */
 /* time, the Julian day and fractional part of the day, the offset to the    */
@@ -121,20 +137,38 @@ int *mon, *day, *yea;
 real ProcessInput(fDate)
 bool fDate;
 {
-  real Off, Ln;
+  CS *pcs = is.pcs;
+  real Off;
 
   TT = RSgn(TT)*RFloor(RAbs(TT))+RFract(RAbs(TT))*100.0/60.0 +
     (DecToDeg(ZZ) - DecToDeg(SS));
-  OO = DecToDeg(OO);
-  AA = Min(AA, 89.9999);        /* Make sure the chart isn't being cast */
-  AA = Max(AA, -89.9999);       /* on the precise north or south pole.  */
-  AA = RFromD(DecToDeg(AA));
+
+  /* When stepping through a search with CastChartStep(), the location has */
+  /* already been converted, and the Julian day is kept for each date.     */
+
+  if (pcs != NULL) {
+    OO = pcs->rLon;
+    AA = pcs->rLat;
+  } else {
+    OO = DecToDeg(OO);
+    AA = Min(AA, 89.9999);        /* Make sure the chart isn't being cast */
+    AA = Max(AA, -89.9999);       /* on the precise north or south pole.  */
+    AA = RFromD(DecToDeg(AA));
+  }
 
   /* if parameter 'fDate' isn't set, then we can assume that the true time */
   /* has already been determined (as in a -rm switch time midpoint chart). */
 
   if (fDate) {
-    is.JD = (real)MdyToJulian(MM, DD, YY);
+    if (pcs == NULL)
+      is.JD = (real)MdyToJulian(MM, DD, YY);
+    else {
+      if (MM != pcs->mon || DD != pcs->day || YY != pcs->yea) {
+        pcs->mon = MM; pcs->day = DD; pcs->yea = YY;
+        pcs->jd = (real)MdyToJulian(MM, DD, YY);
+      }
+      is.JD = pcs->jd;
+    }
     if (!us.fProgress || us.fSolarArc)
       T = (is.JD + TT/24.0 - 2415020.5) / 36525.0;
     else {
@@ -148,10 +182,7 @@ bool fDate;
   /* Compute angle that the ecliptic is inclined to the Celestial Equator */
   OB = RFromD(23.452294-0.0130125*T);
 
-  Ln = Mod((933060-6962911*T+7.5*T*T)/3600.0);    /* Mean lunar node */
-  Off = (259205536.0*T+2013816.0)/3600.0;         /* Mean Sun        */
-  Off = 17.23*RSin(RFromD(Ln))+1.27*RSin(RFromD(Off))-(5025.64+1.11*T)*T;
-  Off = (Off-84038.27)/3600.0;
+  Off = RSiderealOffset(T);
   is.rSid = (us.fSidereal ? Off : 0.0) + us.rZodiacOffset;
   return Off;
 }
@@ -290,7 +321,7 @@ real CuspAscendant()
 {
   real Asc;
 
-  Asc = Angle(-RSin(RA)*RCos(OB)-RTan(AA)*RSin(OB), RCos(RA));
+  Asc = Angle(-RSin(RA)*RCos(OB)-RTanLat()*RSin(OB), RCos(RA));
   return Mod(DFromR(Asc)+is.rSid);
 }
 
@@ -309,17 +340,20 @@ real CuspPlacidus(deg, FF, fNeg)
 real deg, FF;
 bool fNeg;
 {
-  real LO, R1, XS, X;
+  real LO, R1, XS, X, rTanOB, rTanAA;
   int i;
 
   R1 = RA+RFromD(deg);
   X = fNeg ? 1.0 : -1.0;
-  /* Looping 10 times is arbitrary, but it's what other programs do. */
-  for (i = 1; i <= 10; i++) {
 
-    /* This formula works except at 0 latitude (AA == 0.0). */
+  /* This formula works except at 0 latitude (AA == 0.0). */
+
+  rTanOB = RTan(OB);
+  rTanAA = AA == 0.0 ? RTan(0.0001) : RTanLat();
 
-    XS = X*RSin(R1)*RTan(OB)*RTan(AA == 0.0 ? 0.0001 : AA);
+  /* Looping 10 times is arbitrary, but it's what other programs do. */
+  for (i = 1; i <= 10; i++) {
+    XS = X*RSin(R1)*rTanOB*rTanAA;
     XS = RAcos(XS);
     if (XS < 0.0)
       XS += rPi;
@@ -333,6 +367,41 @@ bool fNeg;
   return DFromR(LO);
 }
 
+/* Like CuspPlacidus(), but find the same cusp for a set of locations at  */
+/* once, given each one's RAMC and latitude in radians. All locations are */
+/* stepped together, so the loop does the same work for each of them.     */
+
+void CuspPlacidusBatch(deg, FF, fNeg, rgRA, rgAA, rgCusp, c)
+real deg, FF;
+bool fNeg;
+real *rgRA, *rgAA, *rgCusp;
+int c;
+{
+  real rgR1[BATCHBLOCK], rgTan[BATCHBLOCK], X, XS, LO;
+  int i, j;
+
+  X = fNeg ? 1.0 : -1.0;
+  for (j = 0; j < c; j++) {
+    rgR1[j] = rgRA[j]+RFromD(deg);
+    rgTan[j] = X*RTan(OB)*RTan(rgAA[j] == 0.0 ? 0.0001 : rgAA[j]);
+  }
+  for (i = 1; i <= 10; i++)
+    for (j = 0; j < c; j++) {
+      XS = RAcos(RSin(rgR1[j])*rgTan[j]);
+      if (XS < 0.0)
+        XS += rPi;
+      rgR1[j] = rgRA[j] + (fNeg ? rPi-(XS/FF) : (XS/FF));
+    }
+  for (j = 0; j < c; j++) {
+    LO = RAtn(RTan(rgR1[j])/RCos(OB));
+    if (LO < 0.0)
+      LO += rPi;
+    if (RSin(rgR1[j]) < 0.0)
+      LO += rPi;
+    rgCusp[j] = DFromR(LO);
+  }
+}
+
 void HousePlacidus()
 {
   int i;
@@ -505,21 +574,49 @@ real r0, r1, r2;
 }
 
 
-/* Another coordinate transformation. This is used by the ComputePlanets() */
-/* procedure to rotate rectangular coordinates by a certain amount.        */
+/* Another coordinate transformation. This is used by the                 */
+/* ComputePlanets() procedure to rotate perifocal coordinates into the    */
+/* ecliptic, given the sine and cosine of the perihelion, node, and       */
+/* inclination angles in turn.                                            */
 
-void RecToSph2(AP, AN, IN, X, Y, G)
-real AP, AN, IN, *X, *Y, *G;
+void RecToSph2(rgrot, X, Y, G)
+real *rgrot, *X, *Y, *G;
 {
-  real R, D, A;
+  real X1, Y1;
+
+  X1 = *X*rgrot[1] - *Y*rgrot[0];    /* Rotate by argument of perihelion. */
+  Y1 = *X*rgrot[0] + *Y*rgrot[1];
+  *G = Y1*rgrot[5];                  /* Tilt by the inclination.          */
+  Y1 *= rgrot[4];
+  *X = X1*rgrot[3] - Y1*rgrot[2];    /* Rotate by the ascending node.     */
+  *Y = X1*rgrot[2] + Y1*rgrot[3];
+}
 
-  RecToPol(*X, *Y, &A, &R); A += AP; PolToRec(A, R, X, Y);
-  D = *X; *X = *Y; *Y = 0.0; RecToPol(*X, *Y, &A, &R);
-  A += IN; PolToRec(A, R, X, Y);
-  *G = *Y; *Y = *X; *X = D; RecToPol(*X, *Y, &A, &R); A += AN;
-  if (A < 0.0)
-    A += 2.0*rPi;
-  PolToRec(A, R, X, Y);
+
+/* Solve Kepler's equation for a set of bodies at once, given their mean  */
+/* anomalies and eccentricities. Every body is stepped together, which    */
+/* stops as soon as all of them have settled, or else after the five      */
+/* passes the orbital elements and error terms were designed around.      */
+
+void SolveKepler(rgM, rgE, rgEA, cEA)
+real *rgM, *rgE, *rgEA;
+int cEA;
+{
+  real EA, rMax;
+  int i, j;
+
+  for (j = 0; j < cEA; j++)
+    rgEA[j] = rgM[j];
+  for (i = 1; i <= 5; i++) {
+    rMax = 0.0;
+    for (j = 0; j < cEA; j++) {
+      EA = rgM[j]+rgE[j]*RSin(rgEA[j]);
+      rMax = Max(rMax, RAbs(EA-rgEA[j]));
+      rgEA[j] = EA;
+    }
+    if (rMax < rSmall)
+      break;
+  }
 }
 
 
@@ -586,34 +683,48 @@ void ComputePlanets()
   real heliox[oNorm+1], helioy[oNorm+1], helioz[oNorm+1];
   real helio[oNorm+1], helioalt[oNorm+1], helioret[oNorm+1];
 
-  real aber = 0.0, AU, E, EA, E1, M, XW, YW, AP, AN, IN, X, Y, G, XS, YS, ZS;
-  int ind = oSun, i;
+  real rgM[oNorm+1], rgE[oNorm+1], rgEA[oNorm+1], rgrot[oNorm+1][6];
+  real aber = 0.0, AU, E, E1, R, SE, CE, XW, YW, X, Y, G, XS, YS, ZS;
+  int rgind[oNorm+1], ind, cind = 0, i;
   OE *poe;
 
-  while (ind <= (us.fUranian ? oNorm : cPlanet)) {
+  /* Evaluate the orbital elements of every body wanted first, so that */
+  /* Kepler's equation can then be solved for all of them together.    */
+
+  for (ind = oSun; ind <= (us.fUranian ? oNorm : cPlanet);
+      ind += (ind == oSun ? 2 : (ind != cPlanet ? 1 : uranLo-cPlanet))) {
     if (ignore[ind] && ind > oSun)
-      goto LNextPlanet;
+      continue;
     poe = &rgoe[IoeFromObj(ind)];
-
-    EA = M = ModRad(ReadThree(poe->ma0, poe->ma1, poe->ma2));
-    E = DFromR(ReadThree(poe->ec0, poe->ec1, poe->ec2));
-    for (i = 1; i <= 5; i++)
-      EA = M+E*RSin(EA);            /* Solve Kepler's equation */
-    AU = poe->sma;                  /* Semi-major axis         */
-    E1 = 0.01720209/(pow(AU, 1.5)*
-      (1.0-E*RCos(EA)));                     /* Begin velocity coordinates */
-    XW = -AU*E1*RSin(EA);                    /* Perifocal coordinates      */
-    YW = AU*E1*pow(1.0-E*E,0.5)*RCos(EA);
-    AP = ReadThree(poe->ap0, poe->ap1, poe->ap2);
-    AN = ReadThree(poe->an0, poe->an1, poe->an2);
-    IN = ReadThree(poe->in0, poe->in1, poe->in2); /* Calculate inclination  */
+    rgind[cind] = ind;
+    rgM[cind] = ModRad(ReadThree(poe->ma0, poe->ma1, poe->ma2));
+    rgE[cind] = DFromR(ReadThree(poe->ec0, poe->ec1, poe->ec2));
+    R = ReadThree(poe->ap0, poe->ap1, poe->ap2);  /* Perihelion  */
+    rgrot[cind][0] = RSin(R); rgrot[cind][1] = RCos(R);
+    R = ReadThree(poe->an0, poe->an1, poe->an2);  /* Node        */
+    rgrot[cind][2] = RSin(R); rgrot[cind][3] = RCos(R);
+    R = ReadThree(poe->in0, poe->in1, poe->in2);  /* Inclination */
+    rgrot[cind][4] = RCos(R); rgrot[cind][5] = RSin(R);
+    cind++;
+  }
+  SolveKepler(rgM, rgE, rgEA, cind);
+
+  for (i = 0; i < cind; i++) {
+    ind = rgind[i];
+    E = rgE[i];
+    SE = RSin(rgEA[i]); CE = RCos(rgEA[i]);
+    R = RSqr(1.0-E*E);
+    AU = rgoe[IoeFromObj(ind)].sma;          /* Semi-major axis            */
+    E1 = 0.01720209/(AU*RSqr(AU)*(1.0-E*CE)); /* Begin velocity coordinates */
+    XW = -AU*E1*SE;                          /* Perifocal coordinates      */
+    YW = AU*E1*R*CE;
     X = XW; Y = YW;
-    RecToSph2(AP, AN, IN, &X, &Y, &G);  /* Rotate velocity coords */
+    RecToSph2(rgrot[i], &X, &Y, &G);    /* Rotate velocity coords */
     heliox[ind] = X; helioy[ind] = Y;
     helioz[ind] = G;                    /* Helio ecliptic rectangtular */
-    X = AU*(RCos(EA)-E);                /* Perifocal coordinates for        */
-    Y = AU*RSin(EA)*pow(1.0-E*E,0.5);   /* rectangular position coordinates */
-    RecToSph2(AP, AN, IN, &X, &Y, &G);  /* Rotate for rectangular */
+    X = AU*(CE-E);                      /* Perifocal coordinates for        */
+    Y = AU*SE*R;                        /* rectangular position coordinates */
+    RecToSph2(rgrot[i], &X, &Y, &G);    /* Rotate for rectangular */
     XS = X; YS = Y; ZS = G;             /* position coordinates   */
     if (FBetween(ind, oJup, oPlu))
       ErrorCorrect(ind, &XS, &YS, &ZS);
@@ -621,8 +732,6 @@ void ComputePlanets()
       (XS*helioy[ind]-YS*heliox[ind])/(XS*XS+YS*YS);
     spacex[ind] = XS; spacey[ind] = YS; spacez[ind] = ZS;
     ProcessPlanet(ind, 0.0);
-LNextPlanet:
-    ind += (ind == oSun ? 2 : (ind != cPlanet ? 1 : uranLo-cPlanet));
   }
   spacex[0] = spacey[0] = spacez[0] = 0.0;
 
@@ -0,0 +1,464 @@
+/*
+** Astrolog (Version 5.05) File: panchang.c
+**
+** IMPORTANT NOTICE: The graphics database and chart display routines
+** used in this program are Copyright (C) 1991-1995 by Walter D. Pullen
+** (astara@u.washington.edu). Permission is granted to freely use and
+** distribute these routines provided one doesn't sell, restrict, or
+** profit from them in any way. Modification is allowed provided these
+** notices remain with any altered or edited versions of the program.
+**
+** Panchang event index files: every nakshatra, tithi, yoga, and Moon
+** rasi change over a span of time, computed once and written as sorted
+** fixed width records, so later lookups are a binary search in memory
+** instead of another -dm search run.
+*/
+
+#include "astrolog.h"
+
+#ifdef MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define PANCHANGSTEP 0.25  /* Days between samples when looking for changes. */
+#define PANCHANGPREC 1E-5  /* Days to narrow each change time down to (~1s). */
+
+char szPanchangMagic[4] = {'P', 'N', 'C', 'H'};
+
+/* Number of periods in a full cycle, and index of the first period, for */
+/* each kind of panchang event, in the same numbering as getNaksatra(),  */
+/* getTithi(), getYogas(), and SFromZ() use when displaying charts.      */
+
+int rgcPanchang[cPanchang] = {27, 30, 27, 12};
+int rgiPanchang[cPanchang] = {0, 1, 0, 1};
+char *szPanchangKind[cPanchang] = {"Nakshatra", "Tithi", "Yoga", "Rasi"};
+
+
+/*
+******************************************************************************
+** Panchang Index Generation.
+******************************************************************************
+*/
+
+/* Cast a chart for the given Julian day in Universal Time, and compute the */
+/* continuous quantities each panchang period is the integer part of: the   */
+/* Moon's nakshatra, the Moon's elongation from the Sun in tithis, the sum  */
+/* of the Sun and Moon in yogas, and the Moon's sign. All of these always   */
+/* increase with time, which is what lets changes be found by bracketing.   */
+
+void PanchangState(jd, rgr)
+real jd, *rgr;
+{
+  real jdn;
+  int mon, day, yea;
+
+  jdn = RFloor(jd + rRound);
+  JulianToMdy(jdn, &mon, &day, &yea);
+  SetCI(ciCore, mon, day, yea, DegToDec((jd + rRound - jdn) * 24.0),
+    0.0, 0.0, OO, AA);
+  CastChartMask(fTrue, cmObj);
+  rgr[pkNaksatra] = planet[oMoo] / (rDegMax / 27.0);
+  rgr[pkTithi]    = Mod(planet[oMoo] - planet[oSun]) / 12.0;
+  rgr[pkYoga]     = Mod(planet[oMoo] + planet[oSun]) / (rDegMax / 27.0);
+  rgr[pkRasi]     = planet[oMoo] / 30.0;
+}
+
+
+/* Given a panchang quantity at the start and end of a sample step, which */
+/* crosses an integer boundary in between, find when the crossing happens */
+/* using the Illinois variant of regula falsi, which keeps the crossing   */
+/* bracketed the whole time but still converges in a few chart casts.     */
+
+real JdPanchangCross(pk, jd1, r1, jd2, r2)
+int pk;
+real jd1, r1, jd2, r2;
+{
+  real rgr[cPanchang], rBase, rBound, rCycle, jd, r, g1, g2, g;
+  int side = 0, i;
+
+  rCycle = (real)rgcPanchang[pk];
+  rBase = r1;
+  rBound = RFloor(r1) + 1.0;
+  g1 = r1 - rBound;
+  g2 = r2 < rBase ? r2 + rCycle - rBound : r2 - rBound;
+  jd = jd2;
+  for (i = 0; i < 50 && jd2 - jd1 > PANCHANGPREC; i++) {
+    jd = jd1 - g1 * (jd2 - jd1) / (g2 - g1);
+    if (jd <= jd1 || jd >= jd2)
+      jd = (jd1 + jd2) / 2.0;
+    PanchangState(jd, rgr);
+    r = rgr[pk];
+    g = r < rBase ? r + rCycle - rBound : r - rBound;
+    if (g == 0.0)
+      break;
+    if (g < 0.0) {
+      jd1 = jd; g1 = g;
+      if (side < 0)
+        g2 /= 2.0;
+      side = -1;
+    } else {
+      jd2 = jd; g2 = g;
+      if (side > 0)
+        g1 /= 2.0;
+      side = 1;
+    }
+  }
+  return jd;
+}
+
+
+/* Write a panchang event index file covering the given span of Julian    */
+/* days, as done with the -# switch. We step through the span, and every  */
+/* time a quantity's integer part changes we narrow down when and record  */
+/* the period that starts then. Changes found within one step are sorted  */
+/* before being written, so the whole file is in order by time. Charts    */
+/* are cast with the current settings, so e.g. -s gives sidereal periods. */
+
+bool FWritePanchang(szFile, jdLo, jdHi)
+char *szFile;
+real jdLo, jdHi;
+{
+  char sz[cchSzDef];
+  FILE *file;
+  PH ph;
+  PE rgpe[cPanchang], pe;
+  CI ciSav;
+  real rgr1[cPanchang], rgr2[cPanchang], jd1, jd2;
+  byte rgfIgnore[objMax];
+  int cpe, ipe, pk, i, j, fErr;
+
+  file = fopen(szFile, "wb");
+  if (file == NULL) {
+    sprintf(sz, "File %s can not be created.", szFile);
+    PrintError(sz);
+    return fFalse;
+  }
+
+  /* Only the Sun and Moon are needed, so skip computing anything else. */
+
+  ciSav = ciCore;
+  for (i = 0; i < objMax; i++) {
+    rgfIgnore[i] = ignore[i];
+    ignore[i] = i != oSun && i != oMoo;
+  }
+
+  ClearB((lpbyte)&ph, sizeof(PH));
+  for (i = 0; i < 4; i++)
+    ph.szMagic[i] = szPanchangMagic[i];
+  ph.nVersion = PANCHANGVER;
+  ph.fSidereal = us.fSidereal;
+  ph.jdLo = jdLo; ph.jdHi = jdHi;
+  ph.rOffset = us.rZodiacOffset;
+  fwrite(&ph, sizeof(PH), 1, file);
+
+  cpe = 0;
+  jd1 = jdLo;
+  PanchangState(jd1, rgr1);
+  while (jd1 < jdHi) {
+    jd2 = Min(jd1 + PANCHANGSTEP, jdHi);
+    PanchangState(jd2, rgr2);
+    ipe = 0;
+    for (pk = 0; pk < cPanchang; pk++) {
+      if (RFloor(rgr1[pk]) == RFloor(rgr2[pk]))
+        continue;
+      rgpe[ipe].jd = JdPanchangCross(pk, jd1, rgr1[pk], jd2, rgr2[pk]);
+      i = ((int)RFloor(rgr1[pk]) + 1) % rgcPanchang[pk];
+      rgpe[ipe].code = PanchangCode(pk, i + rgiPanchang[pk]);
+      rgpe[ipe].nReserved = 0;
+      ipe++;
+    }
+
+    /* At most one change of each kind fits in a step, so this is short. */
+
+    for (i = 1; i < ipe; i++)
+      for (j = i; j > 0 && rgpe[j-1].jd > rgpe[j].jd; j--) {
+        pe = rgpe[j-1]; rgpe[j-1] = rgpe[j]; rgpe[j] = pe;
+      }
+    fwrite(rgpe, sizeof(PE), ipe, file);
+    cpe += ipe;
+    for (pk = 0; pk < cPanchang; pk++)
+      rgr1[pk] = rgr2[pk];
+    jd1 = jd2;
+  }
+
+  /* Now that we know how many events there are, fill in the header. */
+
+  ph.cpe = cpe;
+  fseek(file, 0L, SEEK_SET);
+  fwrite(&ph, sizeof(PH), 1, file);
+  fErr = ferror(file);
+  fclose(file);
+
+  for (i = 0; i < objMax; i++)
+    ignore[i] = rgfIgnore[i];
+  ciCore = ciSav;
+  CastChart(fTrue);
+
+  if (fErr) {
+    sprintf(sz, "File %s could not be written.", szFile);
+    PrintError(sz);
+    return fFalse;
+  }
+  sprintf(sz, "%d panchang events written to %s.\n", cpe, szFile);
+  PrintSz(sz);
+  return fTrue;
+}
+
+
+/*
+******************************************************************************
+** Panchang Index Queries.
+******************************************************************************
+*/
+
+/* Open a panchang event index file written by FWritePanchang(). Where the */
+/* system supports it the file is mapped straight into memory, otherwise   */
+/* it's read in whole. Returns NULL if the file is missing or not valid.   */
+
+PN *PnOpenPanchang(szFile)
+char *szFile;
+{
+  char sz[cchSzDef];
+  PN *pn;
+  byte FPTR *pb = NULL;
+  long cb;
+  _bool fMap = fFalse;
+  int i;
+#ifdef MMAP
+  struct stat st;
+  int fd;
+#else
+  FILE *file;
+#endif
+
+#ifdef MMAP
+  fd = open(szFile, O_RDONLY);
+  if (fd >= 0) {
+    if (fstat(fd, &st) == 0 && (cb = (long)st.st_size) >= (long)sizeof(PH)) {
+      pb = (byte FPTR *)mmap(NULL, (size_t)cb, PROT_READ, MAP_SHARED, fd, 0);
+      if (pb == (byte FPTR *)MAP_FAILED)
+        pb = NULL;
+      fMap = pb != NULL;
+    }
+    close(fd);
+  }
+#else
+  file = fopen(szFile, "rb");
+  if (file != NULL) {
+    fseek(file, 0L, SEEK_END);
+    cb = ftell(file);
+    fseek(file, 0L, SEEK_SET);
+    if (cb >= (long)sizeof(PH) &&
+      (pb = (byte FPTR *)PAllocate(cb, fTrue, "panchang")) != NULL &&
+      fread(pb, 1, (size_t)cb, file) != (size_t)cb) {
+      DeallocateFar(pb);
+      pb = NULL;
+    }
+    fclose(file);
+  }
+#endif
+  if (pb == NULL) {
+    sprintf(sz, "Panchang file %s could not be opened.", szFile);
+    PrintWarning(sz);
+    return NULL;
+  }
+
+  /* Make sure this really is a panchang file, and that it's complete. */
+
+  for (i = 0; i < 4; i++)
+    if (((PH FPTR *)pb)->szMagic[i] != szPanchangMagic[i])
+      break;
+  if (i < 4 || ((PH FPTR *)pb)->nVersion != PANCHANGVER ||
+    cb < (long)sizeof(PH) + (long)sizeof(PE)*((PH FPTR *)pb)->cpe ||
+    (pn = (PN *)PAllocate(sizeof(PN), fFalse, "panchang")) == NULL) {
+    sprintf(sz, "File %s is not a valid panchang file.", szFile);
+    PrintWarning(sz);
+#ifdef MMAP
+    munmap((void *)pb, (size_t)cb);
+#else
+    DeallocateFar(pb);
+#endif
+    return NULL;
+  }
+  pn->pph = (PH FPTR *)pb;
+  pn->rgpe = (PE FPTR *)(pb + sizeof(PH));
+  pn->cpe = pn->pph->cpe;
+  pn->cb = cb;
+  pn->fMap = fMap;
+  return pn;
+}
+
+
+/* Release a panchang index opened with PnOpenPanchang(). */
+
+void ClosePanchang(pn)
+PN *pn;
+{
+  if (pn == NULL)
+    return;
+#ifdef MMAP
+  if (pn->fMap)
+    munmap((void *)pn->pph, (size_t)pn->cb);
+  else
+#endif
+    DeallocateFar(pn->pph);
+  DeallocateFar(pn);
+}
+
+
+/* Return the index of the first event in a panchang index at or after the */
+/* given Julian day, or the number of events if there's none that late.    */
+
+int IpeFindPanchang(pn, jd)
+PN *pn;
+real jd;
+{
+  int iLo = 0, iHi = pn->cpe, i;
+
+  while (iLo < iHi) {
+    i = (iLo + iHi) >> 1;
+    if (pn->rgpe[i].jd < jd)
+      iLo = i + 1;
+    else
+      iHi = i;
+  }
+  return iLo;
+}
+
+
+/* Find the events in a panchang index from the first Julian day up to but */
+/* not including the second. The index of the first such event is returned */
+/* in the pointer parameter, and the number of them is the return value.   */
+
+int CpeRangePanchang(pn, jd1, jd2, pipe)
+PN *pn;
+real jd1, jd2;
+int *pipe;
+{
+  int ipe1, ipe2;
+
+  ipe1 = IpeFindPanchang(pn, jd1);
+  ipe2 = jd2 > jd1 ? IpeFindPanchang(pn, jd2) : ipe1;
+  *pipe = ipe1;
+  return ipe2 - ipe1;
+}
+
+
+/* Return the next event of the given kind, e.g. pkTithi, in a panchang   */
+/* index at or after the given Julian day, or the next event of any kind  */
+/* if the kind is negative. Returns NULL if the index ends before there's */
+/* one. Every kind changes at least once every few days, so the scan past */
+/* the binary search only ever looks at a handful of records.             */
+
+PE FPTR *PpeNextPanchang(pn, jd, pk)
+PN *pn;
+real jd;
+int pk;
+{
+  int ipe;
+
+  for (ipe = IpeFindPanchang(pn, jd); ipe < pn->cpe; ipe++)
+    if (pk < 0 || PkFromCode(pn->rgpe[ipe].code) == pk)
+      return &pn->rgpe[ipe];
+  return NULL;
+}
+
+
+/*
+******************************************************************************
+** Panchang Index Display.
+******************************************************************************
+*/
+
+/* Return the name of the period given by a panchang event code, in the  */
+/* same words the -d search uses for nakshatra, tithi, and yoga changes. */
+
+char *SzPanchangPeriod(code)
+int code;
+{
+  extern char *naksatras[], *tithis[], *yogas[], *rasis[];
+  int i = IFromCode(code);
+
+  switch (PkFromCode(code)) {
+  case pkNaksatra: return naksatras[i];
+  case pkTithi:    return tithis[i];
+  case pkYoga:     return yogas[i];
+  }
+  return rasis[i-1];
+}
+
+
+/* Return the local date and time, in the current chart's time zone, of */
+/* the given Julian day (UT), as when a panchang event happens.         */
+
+char *SzPanchangDate(jd)
+real jd;
+{
+  static char szDate[cchSzDef];
+  int mon, day, yea;
+  real jdn;
+
+  jd += (DecToDeg(Dst) - DecToDeg(Zon)) / 24.0;
+  jdn = RFloor(jd + rRound);
+  JulianToMdy(jdn, &mon, &day, &yea);
+  sprintf(szDate, "%s %s", SzDate(mon, day, yea, fFalse),
+    SzTim(DegToDec((jd + rRound - jdn) * 24.0)));
+  return szDate;
+}
+
+
+/* Display the panchang from an event index file written earlier with the */
+/* -# switch, as done with -#l. For the chart time this shows the period  */
+/* of each kind in effect and when it ends, then every change over the    */
+/* following number of days in order, all by looking them up in the index */
+/* rather than searching. Times are shown in the chart's time zone.       */
+
+void ChartPanchang(szFile, jd, cDay)
+char *szFile;
+real jd;
+int cDay;
+{
+  char sz[cchSzDef];
+  PN *pn;
+  PE FPTR *ppe;
+  int ipe, cpe, pk, i;
+
+  pn = PnOpenPanchang(szFile);
+  if (pn == NULL)
+    return;
+  if (jd < pn->pph->jdLo || jd + (real)cDay > pn->pph->jdHi) {
+    sprintf(sz, "Panchang file %s doesn't cover all days asked for.",
+      szFile);
+    PrintWarning(sz);
+  }
+
+  /* The period of each kind in effect now is the one before the next   */
+  /* change of that kind, so the index doesn't need to go back in time. */
+
+  for (pk = 0; pk < cPanchang; pk++) {
+    ppe = PpeNextPanchang(pn, jd, pk);
+    if (ppe == NULL)
+      continue;
+    i = IFromCode(ppe->code) - rgiPanchang[pk];
+    i = (i + rgcPanchang[pk] - 1) % rgcPanchang[pk] + rgiPanchang[pk];
+    sprintf(sz, "%-9s %-14s until %s\n", szPanchangKind[pk],
+      SzPanchangPeriod(PanchangCode(pk, i)), SzPanchangDate(ppe->jd));
+    PrintSz(sz);
+  }
+  PrintL();
+
+  cpe = CpeRangePanchang(pn, jd, jd + (real)cDay, &ipe);
+  for (i = 0; i < cpe; i++) {
+    ppe = &pn->rgpe[ipe+i];
+    sprintf(sz, "%s  %-9s %s\n", SzPanchangDate(ppe->jd),
+      szPanchangKind[PkFromCode(ppe->code)], SzPanchangPeriod(ppe->code));
+    PrintSz(sz);
+  }
+  ClosePanchang(pn);
+}
+
+/* panchang.c */
@@ -0,0 +1,216 @@
+/*
+** Astrolog (Version 5.05) File: sink.c
+**
+** IMPORTANT NOTICE: The graphics database and chart display routines
+** used in this program are Copyright (C) 1991-1995 by Walter D. Pullen
+** (astara@u.washington.edu). Permission is granted to freely use and
+** distribute these routines provided one doesn't sell, restrict, or
+** profit from them in any way. Modification is allowed provided these
+** notices remain with any altered or edited versions of the program.
+**
+** Output sinks: chart positions, aspects, events, and dasa periods given
+** as typed records, written as JSON lines, CSV rows, or a packed binary
+** stream, so programs reading the results don't have to parse tables.
+*/
+
+#include "astrolog.h"
+
+char szSinkMagic[4] = {'S', 'I', 'N', 'K'};
+
+/* Names of the nine grahas in astrolog.h's grSun to grKet order, which */
+/* is how dasa lords are given in records.                              */
+
+char *szSinkGraha[cGraha] = {"Sun", "Moon", "Mercury", "Venus", "Mars",
+  "Jupiter", "Saturn", "Rahu", "Ketu"};
+
+char *szSinkKind[4] = {"position", "aspect", "event", "dasa"};
+
+
+/*
+******************************************************************************
+** Record Output.
+******************************************************************************
+*/
+
+/* Return the name of an aspect, or of the kind of event that a negative */
+/* code means when ChartInDaySearch() gives it as an event's aspect.     */
+
+CONST char *SzSinkAspect(asp)
+int asp;
+{
+  if (asp > 0 && asp <= cAspect)
+    return szAspectAbbrev[asp];
+  switch (asp) {
+  case aSig: return "Sign";
+  case aDir: return "Direction";
+  case -9:   return "Speed";
+  case -11:  return "Navamsa";
+  case -13:  return "Nakshatra";
+  case -15:  return "Tithi";
+  case -17:  return "Yoga";
+  }
+  return "";
+}
+
+
+/* Write one record to the output sink chosen with -~. The first record  */
+/* of a run is preceded by a header: the column names for CSV, and an SH */
+/* for the binary stream. JSON lines need no header, as each one names   */
+/* its own fields. Nothing goes through PrintSz(), since there are no    */
+/* columns or screen rows to keep track of.                              */
+
+void SinkRecord(psr)
+CONST SR *psr;
+{
+  static _bool fHeader = fFalse;
+  SH sh;
+
+  if (!fHeader) {
+    fHeader = fTrue;
+    if (us.nSink == skCsv)
+      fprintf(S, "kind,jd,obj1,asp,obj2,r1,r2,r3\n");
+    else if (us.nSink == skBin) {
+      CopyRgb((byte *)szSinkMagic, (byte *)sh.szMagic, 4);
+      sh.nVersion = SINKVER;
+      sh.cbRecord = sizeof(SR);
+      sh.fSidereal = us.fSidereal;
+      fwrite(&sh, sizeof(SH), 1, S);
+    }
+  }
+
+  switch (us.nSink) {
+  case skBin:
+    fwrite(psr, sizeof(SR), 1, S);
+    break;
+  case skCsv:
+    fprintf(S, "%s,%.6f,%d,%d,%d,%.6f,%.6f,%.6f\n", szSinkKind[psr->rk],
+      psr->jd, psr->obj1, psr->asp, psr->obj2, psr->r1, psr->r2, psr->r3);
+    break;
+  case skJson:
+    fprintf(S, "{\"kind\":\"%s\"", szSinkKind[psr->rk]);
+    switch (psr->rk) {
+    case rkPosition:
+      fprintf(S, ",\"jd\":%.6f,\"obj\":\"%s\",\"lon\":%.6f,\"lat\":%.6f,"
+        "\"vel\":%.6f,\"house\":%d", psr->jd, szObjName[psr->obj1],
+        psr->r1, psr->r2, psr->r3, psr->obj2);
+      break;
+    case rkAspect:
+      fprintf(S, ",\"obj1\":\"%s\",\"asp\":\"%s\",\"obj2\":\"%s\","
+        "\"orb\":%.4f,\"power\":%.2f", szObjName[psr->obj1],
+        SzSinkAspect(psr->asp), szObjName[psr->obj2], psr->r1, psr->r2);
+      break;
+    case rkEvent:
+      fprintf(S, ",\"jd\":%.6f,\"obj1\":\"%s\",\"asp\":\"%s\",", psr->jd,
+        szObjName[psr->obj1], SzSinkAspect(psr->asp));
+      if (psr->asp > 0)
+        fprintf(S, "\"obj2\":\"%s\"", szObjName[psr->obj2]);
+      else
+        fprintf(S, "\"to\":%d", psr->obj2);
+      fprintf(S, ",\"sign1\":%d,\"sign2\":%d", (int)psr->r1, (int)psr->r2);
+      break;
+    case rkDasa:
+      fprintf(S, ",\"level\":%d,\"lord\":\"%s\",\"jd\":%.6f,\"end\":%.6f",
+        psr->asp, szSinkGraha[psr->obj1], psr->jd, psr->r1);
+      break;
+    }
+    fprintf(S, "}\n");
+    break;
+  }
+}
+
+
+/* Give the position of an object in the current chart to the sink. */
+
+void SinkPosition(jd, obj)
+real jd;
+int obj;
+{
+  SR sr;
+
+  sr.rk = rkPosition;
+  sr.jd = jd;
+  sr.obj1 = obj; sr.asp = 0; sr.obj2 = inhouse[obj];
+  sr.r1 = planet[obj]; sr.r2 = planetalt[obj]; sr.r3 = DFromR(ret[obj]);
+  SinkRecord(&sr);
+}
+
+
+/* Give an aspect between two objects to the sink, along with its orb in */
+/* degrees (negative if applying) and power as shown in the -a list.     */
+
+void SinkAspect(obj1, asp, obj2, rOrb, rPower)
+int obj1, asp, obj2;
+real rOrb, rPower;
+{
+  SR sr;
+
+  sr.rk = rkAspect;
+  sr.jd = 0.0;
+  sr.obj1 = obj1; sr.asp = asp; sr.obj2 = obj2;
+  sr.r1 = rOrb; sr.r2 = rPower; sr.r3 = 0.0;
+  SinkRecord(&sr);
+}
+
+
+/* Give an event found by ChartInDaySearch() to the sink, as happening at */
+/* the given Julian day.                                                  */
+
+void SinkEvent(jd, pei)
+real jd;
+CONST EI *pei;
+{
+  SR sr;
+
+  sr.rk = rkEvent;
+  sr.jd = jd;
+  sr.obj1 = pei->source; sr.asp = pei->aspect; sr.obj2 = pei->dest;
+  sr.r1 = (real)pei->sign1; sr.r2 = (real)pei->sign2; sr.r3 = 0.0;
+  SinkRecord(&sr);
+}
+
+
+/* Give a dasa period to the sink. Its lord goes in graha order rather */
+/* than the order desa.c keeps lords in.                               */
+
+void SinkDasa(pdp)
+CONST DP *pdp;
+{
+  SR sr;
+
+  sr.rk = rkDasa;
+  sr.jd = pdp->jdStart;
+  sr.obj1 = GrPla[pdp->nLord]; sr.asp = pdp->nLevel; sr.obj2 = 0;
+  sr.r1 = pdp->jdEnd; sr.r2 = sr.r3 = 0.0;
+  SinkRecord(&sr);
+}
+
+
+/* Give the current chart to the sink, as done by the -v listing when -~ */
+/* is in effect: every unrestricted object's position, followed, if the  */
+/* zodiac is sidereal, by the dasas and bhuktis of the 120 year cycle    */
+/* starting from the Moon, which only make sense for a sidereal Moon.    */
+
+void SinkChart()
+{
+  DP dpCycle, dpDasa, dpBhukti;
+  real jd;
+  int i, j;
+
+  jd = JulianDayFromTime(T);
+  for (i = 1; i <= oNorm; i++)
+    if (!ignore[i])
+      SinkPosition(jd, i);
+  if (!us.fSidereal)
+    return;
+  DasaCycle(jd, planet[oMoo], &dpCycle);
+  for (i = 0; i < 9; i++) {
+    DasaChild(&dpCycle, i, &dpDasa);
+    SinkDasa(&dpDasa);
+    for (j = 0; j < 9; j++) {
+      DasaChild(&dpDasa, j, &dpBhukti);
+      SinkDasa(&dpBhukti);
+    }
+  }
+}
+
+/* sink.c */
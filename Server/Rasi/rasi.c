@@ -6,6 +6,8 @@
 #include <unistd.h>
 #include <time.h>
 
+#include "../Ast/astrolog.h"
+
 #define STR_LEN     1024
 
 char *cmd = "rasi";
@@ -145,10 +147,13 @@ horoscope(tHorDetails *hd)
     targv[targc++] = "-A";
     targv[targc++] = "8";
 
-    targv[targc++] = "-!";  // Match Data
+    targv[targc++] = "-~b"; // Positions as binary records
 
     targv[targc] = NULL;
 
+    /* don't let the child inherit output still buffered for the client */
+    fflush(stdout);
+
     if (fork() == 0) {
 
         close(1);
@@ -161,25 +166,42 @@ horoscope(tHorDetails *hd)
     } else {
 
         FILE *pfp;
-        char dummy[STR_LEN];
+        SH sh;
+        SR sr;
+        NK nk;
+        int fMoon;
 
         close(fd[1]);
 
+        /* -~b gives a header and then a record per object, of which  */
+        /* only the Moon's position is needed here. Without it there  */
+        /* is no rasi or nakshatra to give, so stop rather than go on */
+        /* with them unset.                                           */
         pfp = fdopen(fd[0], "r");
-        while (fgets(str, STR_LEN, pfp) != NULL) {
-            int ra;
-            int nak;
-
-            sscanf(str, "%f", &hd->moondeg);
-
-            hd->ra = (hd->moondeg / 30.0);
-            hd->nak = (hd->moondeg / (360.0 / 27.0));
-
+        if (fread(&sh, sizeof(SH), 1, pfp) != 1 ||
+                memcmp(sh.szMagic, szSinkMagic, 4) != 0 ||
+                sh.nVersion != SINKVER || sh.cbRecord != sizeof(SR)) {
+            printf("Invalid chart records from astrolog\n");
+            exit(1);
+        }
+        fMoon = 0;
+        while (fread(&sr, sizeof(SR), 1, pfp) == 1) {
+            if (sr.rk != rkPosition || sr.obj1 != oMoo) {
+                continue;
+            }
+            fMoon = 1;
+            hd->moondeg = sr.r1;
+            NakshatraOf(LZodiacSec(sr.r1), &nk);
+            hd->ra = nk.rasi;
+            hd->nak = nk.nak;
             hd->rasi = rasi[hd->ra];
             hd->naksatra = naksatras[hd->nak];
         }
-
         fclose(pfp);
+        if (!fMoon) {
+            printf("No Moon position from astrolog\n");
+            exit(1);
+        }
     }
 }
 
@@ -392,6 +414,78 @@ star()
     }
 }
 
+/*
+ * match: rank the best matches for one profile out of a file of
+ * profiles. Each line of the file is "id sex moon", where sex is M or F
+ * and moon is the Moon longitude the -~b sink gave for that profile,
+ * as horoscope() reads it, so the charts are only ever cast once. Usage:
+ *
+ *     match <profiles> <id> [count] [threads]
+ */
+void
+match(int argc, char *argv[])
+{
+    MT mt;
+    MR *rgmr;
+    FILE *fp;
+    char str[STR_LEN];
+    char sex[STR_LEN];
+    long id;
+    float moondeg;
+    int rgn[cKuta];
+    int ipr;
+    int count = 10;
+    int threads = 4;
+    int c;
+    int i;
+    int k;
+
+    if (argc < 3) {
+        printf("Usage: %s <profiles> <id> [count] [threads]\n", argv[0]);
+        exit(1);
+    }
+    if (argc > 3) {
+        count = atoi(argv[3]);
+    }
+    if (argc > 4) {
+        threads = atoi(argv[4]);
+    }
+    if ((fp = fopen(argv[1], "r")) == NULL) {
+        printf("Cannot open %s\n", argv[1]);
+        exit(1);
+    }
+
+    memset(&mt, 0, sizeof(MT));
+    while (fgets(str, STR_LEN, fp) != NULL) {
+        if (sscanf(str, "%ld %s %f", &id, sex, &moondeg) != 3) {
+            continue;
+        }
+        if (IAddMatch(&mt, id, (double)moondeg, *sex == 'M') < 0) {
+            exit(1);
+        }
+    }
+    fclose(fp);
+
+    ipr = IprFindMatch(&mt, atol(argv[2]));
+    if (ipr < 0 || count <= 0 || (rgmr = malloc(sizeof(MR) * count)) == NULL) {
+        printf("No profile %s\n", argv[2]);
+        exit(1);
+    }
+
+    c = CMatchBest(&mt, ipr, rgmr, count, threads);
+    for (i = 0; i < c; i++) {
+        NMatchPair(&mt, ipr, rgmr[i].ipr, rgn);
+        printf("%ld %.1f", mt.rgId[rgmr[i].ipr], rgmr[i].nScore / 2.0);
+        for (k = 0; k < cKuta; k++) {
+            printf(" %.1f", rgn[k] / 2.0);
+        }
+        printf("\n");
+    }
+
+    free(rgmr);
+    FreeMatch(&mt);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -399,6 +493,8 @@ main(int argc, char *argv[])
 
     if (strcmp(base, "rasi") == 0) {
         star();
+    } else if (strcmp(base, "match") == 0) {
+        match(argc, argv);
     }
     
     exit(0);